@@ -0,0 +1,629 @@
+// TypeART library
+//
+// Copyright (c) 2017-2022 TypeART Authors
+// Distributed under the BSD 3-Clause license.
+// (See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/BSD-3-Clause)
+//
+// Project home: https://github.com/tudasc/TypeART
+//
+// SPDX-License-Identifier: BSD-3-Clause
+//
+
+#include "AllocMapWrapper.h"
+#include "CallbackInterface.h"
+#include "RuntimeInterface.h"
+#include "TypeDB.h"
+#include "TypeIO.h"
+#include "TypeInterface.h"
+
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <benchmark/benchmark.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Each benchmark thread allocates in its own region of the (48 bit) address space, region 1 holds the prefilled map:
+constexpr unsigned RegionShift = 40;
+constexpr size_t PrefillRegion = 1;
+// Allocations are double[16] at a distance of 256 bytes, i.e., each is followed by a gap of the same size:
+constexpr size_t SlotBytes    = 256;
+constexpr size_t SlotElements = 16;
+constexpr size_t AllocBytes   = SlotElements * sizeof(double);
+// Operations per timed batch, (un-)timed setup of a batch (PauseTiming) is amortized over the batch:
+constexpr size_t Batch      = 256;
+constexpr size_t ScopeBatch = 64;
+constexpr int MaxThreads    = 64;
+// Tolerated slowdown of the benchmarks with the event trace enabled (--event-trace):
+constexpr double TraceOverheadTarget = 0.10;
+// The runtime holds the struct types of the largest type benchmark:
+constexpr int64_t MaxStructTypes = 16384;
+
+constexpr std::array<int64_t, 3> MapSizes{1 << 8, 1 << 12, 1 << 16};
+constexpr std::array<int64_t, 4> ScopeSizes{1, 4, 16, 64};
+constexpr std::array<int64_t, 3> TypeCounts{16, 1024, MaxStructTypes};
+
+inline const void* slot_address(size_t region, size_t slot, size_t offset = 0) {
+  return reinterpret_cast<const void*>((region << RegionShift) + slot * SlotBytes + offset);
+}
+
+inline size_t thread_region(const benchmark::State& state) {
+  return static_cast<size_t>(state.thread_index()) + PrefillRegion + 1;
+}
+
+/**
+ * Pseudo-random sequence of indices in [0, size), size is a power of two (greater than one), see Fibonacci hashing.
+ */
+class IndexSequence {
+  uint64_t next;
+  const unsigned shift;
+
+ public:
+  IndexSequence(uint64_t seed, uint64_t size) : next(seed), shift(64 - __builtin_ctzll(size)) {
+  }
+
+  inline uint64_t operator()() {
+    return (next++ * 0x9E3779B97F4A7C15ULL) >> shift;
+  }
+};
+
+/**
+ * Registers state.range(0) heap allocations with the runtime for the duration of a benchmark run. The first thread
+ * prefills the map before the timed loop, all threads wait at the start of the loop.
+ */
+class PrefilledMap {
+  const size_t size;
+  const bool owner;
+
+ public:
+  explicit PrefilledMap(const benchmark::State& state)
+      : size(static_cast<size_t>(state.range(0))), owner(state.thread_index() == 0) {
+    if (owner) {
+      for (size_t slot = 0; slot < size; ++slot) {
+        __typeart_alloc(slot_address(PrefillRegion, slot), TYPEART_DOUBLE, SlotElements);
+      }
+    }
+  }
+
+  PrefilledMap(const PrefilledMap&) = delete;
+
+  PrefilledMap& operator=(const PrefilledMap&) = delete;
+
+  ~PrefilledMap() {
+    if (owner) {
+      for (size_t slot = 0; slot < size; ++slot) {
+        __typeart_free(slot_address(PrefillRegion, slot));
+      }
+    }
+  }
+};
+
+void alloc_heap(benchmark::State& state) {
+  const PrefilledMap map{state};
+  const auto region = thread_region(state);
+  for (auto _ : state) {
+    for (size_t slot = 0; slot < Batch; ++slot) {
+      __typeart_alloc(slot_address(region, slot), TYPEART_DOUBLE, SlotElements);
+    }
+    state.PauseTiming();
+    for (size_t slot = 0; slot < Batch; ++slot) {
+      __typeart_free(slot_address(region, slot));
+    }
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * Batch));
+}
+
+void free_heap(benchmark::State& state) {
+  const PrefilledMap map{state};
+  const auto region = thread_region(state);
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (size_t slot = 0; slot < Batch; ++slot) {
+      __typeart_alloc(slot_address(region, slot), TYPEART_DOUBLE, SlotElements);
+    }
+    state.ResumeTiming();
+    for (size_t slot = 0; slot < Batch; ++slot) {
+      __typeart_free(slot_address(region, slot));
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * Batch));
+}
+
+void leave_scope(benchmark::State& state) {
+  const PrefilledMap map{state};
+  const auto region     = thread_region(state);
+  const auto num_allocs = static_cast<int>(state.range(1));
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (size_t slot = 0; slot < ScopeBatch * num_allocs; ++slot) {
+      __typeart_alloc_stack(slot_address(region, slot), TYPEART_DOUBLE, SlotElements);
+    }
+    state.ResumeTiming();
+    for (size_t scope = 0; scope < ScopeBatch; ++scope) {
+      __typeart_leave_scope(num_allocs);
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * ScopeBatch));
+  state.counters["stack_frees"] = benchmark::Counter(static_cast<double>(state.iterations() * ScopeBatch * num_allocs),
+                                                     benchmark::Counter::kIsRate);
+}
+
+enum class Query { hit_exact, hit_interior, miss_exact, miss_interior };
+
+/**
+ * Exact: base address of an allocation or of the gap following it. Interior: an element inside of either.
+ */
+inline const void* query_address(Query query, size_t slot) {
+  const size_t element = sizeof(double) * (1 + slot % (SlotElements - 1));
+  switch (query) {
+    case Query::hit_exact:
+      return slot_address(PrefillRegion, slot);
+    case Query::hit_interior:
+      return slot_address(PrefillRegion, slot, element);
+    case Query::miss_exact:
+      return slot_address(PrefillRegion, slot, AllocBytes);
+    case Query::miss_interior:
+      return slot_address(PrefillRegion, slot, AllocBytes + element);
+  }
+  return nullptr;
+}
+
+void get_type(benchmark::State& state, Query query) {
+  const PrefilledMap map{state};
+  IndexSequence slots{static_cast<uint64_t>(state.thread_index()), static_cast<uint64_t>(state.range(0))};
+  int type_id{0};
+  size_t count{0};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(typeart_get_type(query_address(query, slots()), &type_id, &count));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void resolve_type_id(benchmark::State& state) {
+  IndexSequence types{static_cast<uint64_t>(state.thread_index()), static_cast<uint64_t>(state.range(0))};
+  typeart_struct_layout layout;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(typeart_resolve_type_id(TYPEART_NUM_RESERVED_IDS + static_cast<int>(types()), &layout));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+std::vector<typeart::StructTypeInfo> make_struct_types(int64_t count) {
+  std::vector<typeart::StructTypeInfo> types;
+  types.reserve(count);
+  for (int64_t index = 0; index < count; ++index) {
+    types.push_back(typeart::StructTypeInfo{TYPEART_NUM_RESERVED_IDS + static_cast<int>(index),
+                                            "bench_struct_" + std::to_string(index),
+                                            16,
+                                            2,
+                                            {0, 8},
+                                            {TYPEART_INT32, TYPEART_DOUBLE},
+                                            {1, 1},
+                                            typeart::StructTypeFlag::USER_DEFINED});
+  }
+  return types;
+}
+
+// Type databases of the TypeDB benchmarks, indexed like TypeCounts:
+std::array<std::unique_ptr<typeart::TypeDB>, TypeCounts.size()> type_dbs;
+
+void type_db_lookup(benchmark::State& state, const typeart::TypeDB* type_db) {
+  IndexSequence types{static_cast<uint64_t>(state.thread_index()), static_cast<uint64_t>(state.range(0))};
+  for (auto _ : state) {
+    const int type_id = TYPEART_NUM_RESERVED_IDS + static_cast<int>(types());
+    benchmark::DoNotOptimize(type_db->getTypeSize(type_id));
+    benchmark::DoNotOptimize(type_db->getStructInfo(type_id));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * Registers the struct types with the runtime (as an embedded type table) and builds the type databases.
+ */
+void setup_types() {
+  const auto types = make_struct_types(MaxStructTypes);
+  llvm::SmallString<0> table;
+  llvm::raw_svector_ostream stream(table);
+  typeart::io::store_binary(types, stream);
+  // The table must be 8-byte aligned:
+  std::vector<uint64_t> aligned((table.size() + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+  std::memcpy(aligned.data(), table.data(), table.size());
+  __typeart_register_types(aligned.data(), table.size());
+
+  for (size_t index = 0; index < TypeCounts.size(); ++index) {
+    type_dbs[index] = std::make_unique<typeart::TypeDB>();
+    for (const auto& type : make_struct_types(TypeCounts[index])) {
+      type_dbs[index]->registerStruct(type);
+    }
+  }
+}
+
+bool is_thread_safe(const std::string& backend) {
+#ifdef TYPEART_DISABLE_THREAD_SAFETY
+  return false;
+#else
+  return llvm::StringRef{backend}.substr(0, 6) != "unsafe";
+#endif
+}
+
+void register_benchmarks(const std::string& backend, int max_threads) {
+  const int threads = is_thread_safe(backend) ? max_threads : 1;
+  const auto name   = [&backend](const std::string& benchmark) { return (backend + "/" + benchmark); };
+  const auto map_args = [&](benchmark::internal::Benchmark* bench) {
+    for (const auto size : MapSizes) {
+      bench->Arg(size);
+    }
+    bench->ArgName("map_size")->ThreadRange(1, threads)->UseRealTime();
+  };
+
+  map_args(benchmark::RegisterBenchmark(name("alloc_heap").c_str(), alloc_heap));
+  map_args(benchmark::RegisterBenchmark(name("free_heap").c_str(), free_heap));
+
+  auto* scope = benchmark::RegisterBenchmark(name("leave_scope").c_str(), leave_scope);
+  for (const auto size : MapSizes) {
+    for (const auto num_allocs : ScopeSizes) {
+      scope->Args({size, num_allocs});
+    }
+  }
+  scope->ArgNames({"map_size", "k"})->ThreadRange(1, threads)->UseRealTime();
+
+  constexpr std::array<std::pair<const char*, Query>, 4> queries{{{"get_type/hit_exact", Query::hit_exact},
+                                                                  {"get_type/hit_interior", Query::hit_interior},
+                                                                  {"get_type/miss_exact", Query::miss_exact},
+                                                                  {"get_type/miss_interior", Query::miss_interior}}};
+  for (const auto& [query_name, query] : queries) {
+    map_args(benchmark::RegisterBenchmark(name(query_name).c_str(), get_type, query));
+  }
+
+  const auto type_args = [&](benchmark::internal::Benchmark* bench) {
+    for (const auto count : TypeCounts) {
+      bench->Arg(count);
+    }
+    bench->ArgName("types")->ThreadRange(1, threads)->UseRealTime();
+  };
+  type_args(benchmark::RegisterBenchmark(name("resolve_type_id").c_str(), resolve_type_id));
+  for (size_t index = 0; index < TypeCounts.size(); ++index) {
+    benchmark::RegisterBenchmark(name("type_db_lookup").c_str(), type_db_lookup, type_dbs[index].get())
+        ->Arg(TypeCounts[index])
+        ->ArgName("types")
+        ->ThreadRange(1, threads)
+        ->UseRealTime();
+  }
+}
+
+/**
+ * Passes the reports to the console (if any) and to the JSON report of the backend.
+ */
+class TeeReporter : public benchmark::BenchmarkReporter {
+  std::unique_ptr<benchmark::BenchmarkReporter> display;
+  benchmark::JSONReporter json;
+
+ public:
+  TeeReporter(std::unique_ptr<benchmark::BenchmarkReporter> display_reporter, std::ostream& json_out)
+      : display(std::move(display_reporter)) {
+    json.SetOutputStream(&json_out);
+  }
+
+  bool ReportContext(const Context& context) override {
+    const bool run = display == nullptr || display->ReportContext(context);
+    return json.ReportContext(context) && run;
+  }
+
+  void ReportRuns(const std::vector<Run>& reports) override {
+    if (display != nullptr) {
+      display->ReportRuns(reports);
+    }
+    json.ReportRuns(reports);
+  }
+
+  void Finalize() override {
+    if (display != nullptr) {
+      display->Finalize();
+    }
+    json.Finalize();
+  }
+};
+
+struct Options {
+  std::vector<std::string> backends;
+  int max_threads{static_cast<int>(std::max(1U, std::thread::hardware_concurrency()))};
+  std::string out_file;
+  bool json_display{false};
+  bool event_trace{false};
+};
+
+bool select_backends(Options& options) {
+#ifdef TYPEART_MAP_BACKEND_SELECTION
+  if (options.backends.empty()) {
+    options.backends.assign(typeart::PointerMap::strategies.begin(), typeart::PointerMap::strategies.end());
+  }
+  for (const auto& backend : options.backends) {
+    if (!typeart::PointerMap::is_valid(backend)) {
+      std::cerr << "Unknown map backend " << backend << "\n";
+      return false;
+    }
+  }
+#else
+  if (!options.backends.empty()) {
+    std::cerr << "Warning: Built without TYPEART_MAP_BACKEND_SELECTION, measuring the configured backend only\n";
+  }
+  options.backends = {"configured"};
+#endif
+  return true;
+}
+
+/**
+ * Removes the options of the benchmark driver and the output options of Google Benchmark (handled by the driver,
+ * which merges the JSON reports of all backends) from argv.
+ */
+bool parse_options(int& argc, char** argv, Options& options) {
+  int kept{1};
+  for (int index = 1; index < argc; ++index) {
+    const llvm::StringRef arg{argv[index]};
+    if (arg.startswith("--backends=")) {
+      llvm::SmallVector<llvm::StringRef, 8> backends;
+      arg.substr(11).split(backends, ',', -1, false);
+      for (const auto backend : backends) {
+        options.backends.emplace_back(backend.str());
+      }
+    } else if (arg.startswith("--max-threads=")) {
+      if (arg.substr(14).getAsInteger(10, options.max_threads) || options.max_threads < 1 ||
+          options.max_threads > MaxThreads) {
+        std::cerr << "Invalid thread count (1-" << MaxThreads << "): " << arg.str() << "\n";
+        return false;
+      }
+    } else if (arg == "--event-trace") {
+#ifdef TYPEART_EVENT_TRACE
+      options.event_trace = true;
+#else
+      std::cerr << "Built without TYPEART_EVENT_TRACE: " << arg.str() << "\n";
+      return false;
+#endif
+    } else if (arg.startswith("--benchmark_out=")) {
+      options.out_file = arg.substr(16).str();
+    } else if (arg.startswith("--benchmark_out_format=")) {
+      if (arg.substr(23) != "json") {
+        std::cerr << "Only JSON output files are supported: " << arg.str() << "\n";
+        return false;
+      }
+    } else if (arg.startswith("--benchmark_format=")) {
+      const auto value = arg.substr(19);
+      if (value != "json" && value != "console") {
+        std::cerr << "Unsupported output format (console, json): " << arg.str() << "\n";
+        return false;
+      }
+      options.json_display = value == "json";
+    } else {
+      argv[kept++] = argv[index];
+    }
+  }
+  argc = kept;
+  return true;
+}
+
+/**
+ * Runs the benchmarks of one backend in a child process, the runtime selects its map backend (and opens the trace
+ * file) once at startup.
+ * @return the JSON report (empty, if no benchmark matched the filter), None if the child failed.
+ */
+llvm::Optional<std::string> run_isolated(const std::string& backend, const Options& options, bool event_trace) {
+  std::array<int, 2> pipe_fds{};
+  if (pipe(pipe_fds.data()) != 0) {
+    return llvm::None;
+  }
+  const pid_t child = fork();
+  if (child == 0) {
+    close(pipe_fds[0]);
+#ifdef TYPEART_MAP_BACKEND_SELECTION
+    setenv("TYPEART_MAP_BACKEND", backend.c_str(), 1);
+#endif
+    if (options.event_trace) {
+      // Measures the recording of the events, not the file system:
+      event_trace ? setenv("TYPEART_TRACE_FILE", "/dev/null", 1) : unsetenv("TYPEART_TRACE_FILE");
+    }
+    setup_types();
+    register_benchmarks(backend, options.max_threads);
+    std::unique_ptr<benchmark::BenchmarkReporter> display;
+    if (!options.json_display) {
+      display = std::make_unique<benchmark::ConsoleReporter>(isatty(STDOUT_FILENO) != 0
+                                                                 ? benchmark::ConsoleReporter::OO_ColorTabular
+                                                                 : benchmark::ConsoleReporter::OO_Tabular);
+    }
+    std::ostringstream report;
+    TeeReporter reporter{std::move(display), report};
+    benchmark::RunSpecifiedBenchmarks(&reporter);
+    benchmark::Shutdown();
+    std::cout.flush();
+    const auto json = report.str();
+    size_t written{0};
+    while (written < json.size()) {
+      const auto count = write(pipe_fds[1], json.data() + written, json.size() - written);
+      if (count <= 0) {
+        std::_Exit(EXIT_FAILURE);
+      }
+      written += static_cast<size_t>(count);
+    }
+    close(pipe_fds[1]);
+    std::exit(EXIT_SUCCESS);
+  }
+  close(pipe_fds[1]);
+  if (child < 0) {
+    close(pipe_fds[0]);
+    return llvm::None;
+  }
+  std::string report;
+  std::array<char, 4096> buffer;
+  ssize_t count{0};
+  while ((count = read(pipe_fds[0], buffer.data(), buffer.size())) > 0) {
+    report.append(buffer.data(), static_cast<size_t>(count));
+  }
+  close(pipe_fds[0]);
+  int status{0};
+  waitpid(child, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+    return llvm::None;
+  }
+  return report;
+}
+
+/**
+ * Appends the benchmarks of a backend report to the merged report, each tagged with the map backend (and whether the
+ * event trace was enabled, if compared).
+ */
+bool merge_report(const std::string& backend, llvm::StringRef event_trace, llvm::StringRef report,
+                  llvm::json::Value& merged) {
+  auto parsed = llvm::json::parse(report);
+  if (!parsed) {
+    std::cerr << "Invalid report of backend " << backend << ": " << llvm::toString(parsed.takeError()) << "\n";
+    return false;
+  }
+  auto* benchmarks = parsed->getAsObject()->getArray("benchmarks");
+  if (benchmarks != nullptr) {
+    for (auto& entry : *benchmarks) {
+      entry.getAsObject()->try_emplace("map_backend", backend);
+      if (!event_trace.empty()) {
+        entry.getAsObject()->try_emplace("event_trace", event_trace);
+      }
+    }
+  }
+  if (merged.kind() == llvm::json::Value::Null) {
+    merged = std::move(*parsed);
+    return true;
+  }
+  auto* merged_benchmarks = merged.getAsObject()->getArray("benchmarks");
+  if (benchmarks != nullptr && merged_benchmarks != nullptr) {
+    std::move(benchmarks->begin(), benchmarks->end(), std::back_inserter(*merged_benchmarks));
+  }
+  return true;
+}
+
+/**
+ * Compares the mean real time of each benchmark with the event trace enabled and disabled.
+ */
+void report_trace_overhead(const llvm::json::Value& merged) {
+  const auto* benchmarks = merged.getAsObject()->getArray("benchmarks");
+  if (benchmarks == nullptr) {
+    return;
+  }
+  struct Times {
+    std::array<double, 2> sum{};
+    std::array<size_t, 2> count{};
+  };
+  std::vector<std::pair<std::string, Times>> times;
+  for (const auto& entry : *benchmarks) {
+    const auto* object = entry.getAsObject();
+    const auto name    = object->getString("name");
+    const auto trace   = object->getString("event_trace");
+    const auto time    = object->getNumber("real_time");
+    if (!name || !trace || !time || object->getString("run_type") == llvm::StringRef{"aggregate"}) {
+      continue;
+    }
+    auto it = std::find_if(times.begin(), times.end(), [&](const auto& named) { return named.first == *name; });
+    if (it == times.end()) {
+      it = times.insert(times.end(), {name->str(), Times{}});
+    }
+    const size_t index = *trace == "on" ? 1 : 0;
+    it->second.sum[index] += *time;
+    ++it->second.count[index];
+  }
+
+  size_t above_target{0};
+  std::cerr << "Event trace overhead (target: < " << TraceOverheadTarget * 100 << "%):\n";
+  for (const auto& [name, time] : times) {
+    if (time.count[0] == 0 || time.count[1] == 0 || time.sum[0] <= 0) {
+      continue;
+    }
+    const double overhead = (time.sum[1] / time.count[1]) / (time.sum[0] / time.count[0]) - 1;
+    const bool above      = overhead >= TraceOverheadTarget;
+    above_target += above ? 1 : 0;
+    std::cerr << llvm::formatv("  {0,-72} {1,7:P}{2}\n", name, overhead, above ? "  (above target)" : "").str();
+  }
+  std::cerr << above_target << " of " << times.size() << " benchmarks above target\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!parse_options(argc, argv, options)) {
+    return EXIT_FAILURE;
+  }
+  benchmark::Initialize(&argc, argv, [] {
+    benchmark::PrintDefaultHelp();
+    std::cout << "  [--backends=<backend>,...]  Map backends, see TYPEART_MAP_BACKEND (default: all strategies)\n"
+                 "  [--max-threads=<n>]         Up to n threads (powers of two, default: hardware threads)\n"
+                 "  [--event-trace]             Runs each backend with the event trace disabled and enabled, and reports\n"
+                 "                              the overhead of the trace\n";
+  });
+  if (benchmark::ReportUnrecognizedArguments(argc, argv) || !select_backends(options)) {
+    return EXIT_FAILURE;
+  }
+  benchmark::AddCustomContext("typeart_version", typeart_get_project_version());
+
+  bool success{true};
+  llvm::json::Value merged = nullptr;
+  for (const auto& backend : options.backends) {
+    for (const bool event_trace : {false, true}) {
+      if (event_trace && !options.event_trace) {
+        continue;
+      }
+      const auto report = run_isolated(backend, options, event_trace);
+      if (!report) {
+        std::cerr << "Benchmarks of map backend " << backend << " failed\n";
+        success = false;
+        continue;
+      }
+      if (report->empty()) {
+        // No benchmark matched the filter:
+        continue;
+      }
+      const llvm::StringRef trace_tag = options.event_trace ? (event_trace ? "on" : "off") : "";
+      success &= merge_report(backend, trace_tag, *report, merged);
+    }
+  }
+
+  if (options.event_trace && merged.kind() != llvm::json::Value::Null) {
+    report_trace_overhead(merged);
+  }
+
+  if (merged.kind() == llvm::json::Value::Null && success) {
+    merged = llvm::json::Object{{"benchmarks", llvm::json::Array{}}};
+  }
+  if (merged.kind() != llvm::json::Value::Null) {
+    if (options.json_display) {
+      llvm::outs() << llvm::formatv("{0:2}", merged) << "\n";
+    }
+    if (!options.out_file.empty()) {
+      std::error_code error;
+      llvm::raw_fd_ostream out(options.out_file, error);
+      if (error) {
+        std::cerr << "Failed to write " << options.out_file << ": " << error.message() << "\n";
+        return EXIT_FAILURE;
+      }
+      out << llvm::formatv("{0:2}", merged) << "\n";
+    }
+  }
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -53,9 +53,46 @@ add_feature_info(LLVM_CODE_COVERAGE TYPEART_LLVM_CODE_COVERAGE "Enable LLVM code
 option(TYPEART_SAFEPTR "Use external safe_ptr map wrapper instead of mutex" OFF)
 add_feature_info(SAFEPTR TYPEART_SAFEPTR "External library object_threadsafe provides lock-free runtime pointer map wrapper.")
 
-cmake_dependent_option(TYPEART_DISABLE_THREAD_SAFETY "Explicitly make runtime *not* thread-safe." OFF
+cmake_dependent_option(TYPEART_SHARDED_MAP "Use address-sharded runtime pointer map, each shard is locked separately." OFF
+  "NOT TYPEART_SAFEPTR" OFF
+)
+add_feature_info(SHARDED_MAP TYPEART_SHARDED_MAP "Runtime pointer map is split into independently locked address shards.")
+
+cmake_dependent_option(TYPEART_LEFT_RIGHT_MAP "Use left-right runtime pointer map, queries take no lock." OFF
+  "NOT TYPEART_SAFEPTR;NOT TYPEART_SHARDED_MAP" OFF
+)
+add_feature_info(LEFT_RIGHT_MAP TYPEART_LEFT_RIGHT_MAP "Runtime pointer map is duplicated (left-right), readers are lock-free.")
+
+cmake_dependent_option(TYPEART_SHADOW_MAP "Use a shadow table for direct-mapped base address lookups of large allocations." OFF
+  "NOT TYPEART_SAFEPTR;NOT TYPEART_SHARDED_MAP;NOT TYPEART_LEFT_RIGHT_MAP" OFF
+)
+add_feature_info(SHADOW_MAP TYPEART_SHADOW_MAP "Runtime resolves base addresses of large allocations with a shadow table.")
+
+set(TYPEART_SHADOW_GRANULE_BITS 12 CACHE STRING "Shadow table granularity, granule size is 2^N bytes.")
+mark_as_advanced(TYPEART_SHADOW_GRANULE_BITS)
+
+cmake_dependent_option(TYPEART_MAP_BACKEND_SELECTION "Build all pointer map backends, select one at startup with env var TYPEART_MAP_BACKEND." OFF
   "NOT TYPEART_SAFEPTR" OFF
 )
+add_feature_info(MAP_BACKEND_SELECTION TYPEART_MAP_BACKEND_SELECTION "Runtime pointer map backend is selected at startup (TYPEART_MAP_BACKEND).")
+
+option(TYPEART_COMPACT_POINTER_INFO "Store compact per-allocation data (32 bit call-site index instead of the return address)." OFF)
+add_feature_info(COMPACT_POINTER_INFO TYPEART_COMPACT_POINTER_INFO "Runtime stores call sites of allocations in a deduplicated table.")
+
+option(TYPEART_LOOKUP_CACHE "Cache the last resolved allocations per thread in front of the pointer map." OFF)
+add_feature_info(LOOKUP_CACHE TYPEART_LOOKUP_CACHE "Runtime caches recently resolved allocations per thread.")
+
+option(TYPEART_DEFERRED_FREE "Queue heap frees per thread and apply them in batches." OFF)
+add_feature_info(DEFERRED_FREE TYPEART_DEFERRED_FREE "Runtime applies heap frees in batches.")
+
+cmake_dependent_option(TYPEART_EVENT_TRACE "Record runtime events to a binary trace file (env var TYPEART_TRACE_FILE)." OFF
+  "NOT TYPEART_DISABLE_THREAD_SAFETY" OFF
+)
+add_feature_info(EVENT_TRACE TYPEART_EVENT_TRACE "Runtime records allocation, free and query events to per-thread trace buffers.")
+
+cmake_dependent_option(TYPEART_DISABLE_THREAD_SAFETY "Explicitly make runtime *not* thread-safe." OFF
+  "NOT TYPEART_SAFEPTR;NOT TYPEART_SHARDED_MAP;NOT TYPEART_LEFT_RIGHT_MAP" OFF
+)
 add_feature_info(DISABLE_THREAD_SAFETY TYPEART_DISABLE_THREAD_SAFETY "Thread-safety features of runtime disabled.")
 
 option(TYPEART_TSAN "Build runtime lib and tests with fsanitize=thread" OFF)
@@ -85,6 +122,9 @@ add_feature_info(PHMAP TYPEART_PHMAP "External library \"parallel-hashmap\" repl
 option(TYPEART_INSTALL_UTIL_SCRIPTS "Install single file build and run scripts" OFF)
 mark_as_advanced(TYPEART_INSTALL_UTIL_SCRIPTS)
 
+option(TYPEART_BENCHMARKS "Build the runtime microbenchmarks (typeart-bench), requires Google Benchmark." OFF)
+add_feature_info(BENCHMARKS TYPEART_BENCHMARKS "Runtime microbenchmarks of the allocation tracking and type queries.")
+
 option(TYPEART_TEST_CONFIGURE_IDE "Add targets so the IDE (e.g., Clion) can interpret test files better" ON)
 mark_as_advanced(TYPEART_TEST_CONFIGURE_IDE)
 
@@ -144,6 +184,15 @@ set_package_properties(MPI PROPERTIES
   "The MPI library is needed for several TypeART components: MPI logging, MPI compiler wrapper, and the MPI interceptor tool."
 )
 
+if(TYPEART_BENCHMARKS)
+  find_package(benchmark REQUIRED)
+endif()
+set_package_properties(benchmark PROPERTIES
+  TYPE OPTIONAL
+  PURPOSE
+  "Google Benchmark is needed for the runtime microbenchmarks (TYPEART_BENCHMARKS)."
+)
+
 if(TYPEART_MPI_INTERCEPT_LIB)
   find_package(Python3 REQUIRED)
 endif()
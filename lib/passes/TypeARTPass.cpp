@@ -19,24 +19,34 @@
 #include "support/Logger.h"
 #include "support/Table.h"
 #include "typegen/TypeGenerator.h"
+#include "typelib/TypeIO.h"
 
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/IR/Constants.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/InstrTypes.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/Alignment.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/ModuleUtils.h"
 
 #include <cassert>
 #include <cstddef>
 #include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace llvm {
 class BasicBlock;
@@ -54,6 +64,35 @@ static cl::OptionCategory typeart_category("TypeART instrumentation pass", "Thes
 static cl::opt<std::string> cl_typeart_type_file("typeart-types", cl::desc("Location of the generated type file."),
                                                  cl::cat(typeart_category));
 
+static cl::opt<bool> cl_typeart_embed_types(
+    "typeart-embed-types",
+    cl::desc("Embed the struct layouts in the module, registered with the runtime by a module constructor."),
+    cl::Hidden, cl::init(false), cl::cat(typeart_category));
+
+static cl::opt<typeart::TypeIdScheme> cl_typeart_type_ids(
+    "typeart-type-ids", cl::desc("Select how struct type IDs are assigned."),
+    cl::values(clEnumValN(typeart::TypeIdScheme::sequential, "sequential",
+                          "Sequential IDs, modules share the type file and must be compiled one at a time (default)"),
+               clEnumValN(typeart::TypeIdScheme::hash, "hash",
+                          "IDs hashed from name and layout, modules can be compiled in parallel with separate type "
+                          "files")),
+    cl::init(typeart::TypeIdScheme::sequential), cl::cat(typeart_category));
+
+static cl::opt<unsigned> cl_typeart_type_id_seed(
+    "typeart-type-id-seed",
+    cl::desc("Seed of hashed struct type IDs, must be the same for all modules. A different seed resolves type ID "
+             "collisions."),
+    cl::Hidden, cl::init(0), cl::cat(typeart_category));
+
+static cl::opt<typeart::TypeStore> cl_typeart_type_store(
+    "typeart-type-store", cl::desc("Select how the type file is updated."),
+    cl::values(clEnumValN(typeart::TypeStore::file, "file",
+                          "Read and rewrite the whole type file (default with sequential type IDs)"),
+               clEnumValN(typeart::TypeStore::journal, "journal",
+                          "Append the types of each module to a locked, append-only type journal (default with hashed "
+                          "type IDs)")),
+    cl::init(typeart::TypeStore::file), cl::cat(typeart_category));
+
 static cl::opt<bool> cl_typeart_stats("typeart-stats", cl::desc("Show statistics for TypeArt type pass."), cl::Hidden,
                                       cl::init(false), cl::cat(typeart_category));
 
@@ -168,7 +207,15 @@ bool TypeArtPass::doInitialization(Module& m) {
     return default_types_file;
   }();
 
-  typeManager = make_typegen(types_file);
+  const auto type_store = [&]() {
+    if (cl_typeart_type_store.getNumOccurrences() == 0 && cl_typeart_type_ids == TypeIdScheme::hash) {
+      // Modules with hashed IDs are compiled in parallel, rewriting a shared type file would drop the types of others:
+      return TypeStore::journal;
+    }
+    return cl_typeart_type_store.getValue();
+  }();
+
+  typeManager = make_typegen(types_file, cl_typeart_type_ids, type_store, cl_typeart_type_id_seed);
 
   LOG_DEBUG("Propagating type infos.");
   const auto [loaded, error] = typeManager->load();
@@ -193,6 +240,12 @@ bool TypeArtPass::doInitialization(Module& m) {
 bool TypeArtPass::runOnModule(Module& m) {
   meminst_finder->runOnModule(m);
 
+  llvm::Function* type_registration{nullptr};
+  if (cl_typeart_embed_types) {
+    // Declared first, the constructor must run before the constructor registering the globals of this module:
+    type_registration = declareTypeRegistration(m);
+  }
+
   bool instrumented_global{false};
   if (cl_typeart_instrument_global) {
     declareInstrumentationFunctions(m);
@@ -206,7 +259,13 @@ bool TypeArtPass::runOnModule(Module& m) {
   }
 
   const auto instrumented_function = llvm::count_if(m.functions(), [&](auto& f) { return runOnFunc(f); }) > 0;
-  return instrumented_function || instrumented_global;
+
+  if (type_registration != nullptr) {
+    // All types used by this module are known after instrumenting it:
+    defineTypeRegistration(m, *type_registration);
+  }
+
+  return instrumented_function || instrumented_global || type_registration != nullptr;
 }
 
 bool TypeArtPass::runOnFunc(Function& f) {
@@ -280,7 +339,7 @@ bool TypeArtPass::doFinalization(Module&) {
 void TypeArtPass::declareInstrumentationFunctions(Module& m) {
   // Remove this return if problems come up during compilation
   if (typeart_alloc_global.f != nullptr && typeart_alloc_stack.f != nullptr && typeart_alloc.f != nullptr &&
-      typeart_free.f != nullptr && typeart_leave_scope.f != nullptr) {
+      typeart_free.f != nullptr && typeart_leave_scope.f != nullptr && typeart_register_types.f != nullptr) {
     return;
   }
 
@@ -289,12 +348,15 @@ void TypeArtPass::declareInstrumentationFunctions(Module& m) {
   auto alloc_arg_types      = instrumentation_helper.make_parameters(IType::ptr, IType::type_id, IType::extent);
   auto free_arg_types       = instrumentation_helper.make_parameters(IType::ptr);
   auto leavescope_arg_types = instrumentation_helper.make_parameters(IType::stack_count);
+  auto register_arg_types   = instrumentation_helper.make_parameters(IType::ptr, IType::extent);
 
   typeart_alloc.f        = decl.make_function(IFunc::heap, typeart_alloc.name, alloc_arg_types);
   typeart_alloc_stack.f  = decl.make_function(IFunc::stack, typeart_alloc_stack.name, alloc_arg_types);
   typeart_alloc_global.f = decl.make_function(IFunc::global, typeart_alloc_global.name, alloc_arg_types);
   typeart_free.f         = decl.make_function(IFunc::free, typeart_free.name, free_arg_types);
   typeart_leave_scope.f  = decl.make_function(IFunc::scope, typeart_leave_scope.name, leavescope_arg_types);
+  typeart_register_types.f =
+      decl.make_function(IFunc::register_types, typeart_register_types.name, register_arg_types);
 
   typeart_alloc_omp.f = decl.make_function(IFunc::heap_omp, typeart_alloc_omp.name, alloc_arg_types, true);
   typeart_alloc_stacks_omp.f =
@@ -304,6 +366,75 @@ void TypeArtPass::declareInstrumentationFunctions(Module& m) {
       decl.make_function(IFunc::scope_omp, typeart_leave_scope_omp.name, leavescope_arg_types, true);
 }
 
+llvm::Function* TypeArtPass::declareTypeRegistration(Module& m) {
+  declareInstrumentationFunctions(m);
+
+  auto& c                = m.getContext();
+  FunctionType* ctorType = FunctionType::get(llvm::Type::getVoidTy(c), false);
+  Function* ctorFunction = Function::Create(ctorType, Function::InternalLinkage, "__typeart_register_module_types", m);
+  llvm::appendToGlobalCtors(m, ctorFunction, 0, nullptr);
+
+  return ctorFunction;
+}
+
+void TypeArtPass::defineTypeRegistration(Module& m, Function& ctor) {
+  std::string table;
+  llvm::raw_string_ostream stream(table);
+  io::store_binary(collectModuleTypes(), stream);
+  stream.flush();
+
+  auto& c          = m.getContext();
+  auto* table_data = ConstantDataArray::getString(c, table, /*AddNull=*/false);
+  auto* table_var  = new GlobalVariable(m, table_data->getType(), /*isConstant=*/true, GlobalValue::PrivateLinkage,
+                                       table_data, "__typeart_type_table");
+  // The table is read in place by the runtime:
+  table_var->setAlignment(llvm::Align(8));
+  if (Triple(m.getTargetTriple()).isOSBinFormatELF()) {
+    table_var->setSection("typeart_types");
+  }
+
+  IRBuilder<> IRB(BasicBlock::Create(c, "entry", &ctor));
+  auto* table_ptr  = IRB.CreateBitOrPointerCast(table_var, instrumentation_helper.getTypeFor(IType::ptr));
+  auto* table_size = ConstantInt::get(instrumentation_helper.getTypeFor(IType::extent), table.size());
+  IRB.CreateCall(functions.getFunctionFor(IFunc::register_types), ArrayRef<Value*>{table_ptr, table_size});
+  IRB.CreateRetVoid();
+}
+
+std::vector<StructTypeInfo> TypeArtPass::collectModuleTypes() const {
+  // The type file may contain the types of all modules, only the types allocated by this module are embedded:
+  llvm::SmallVector<int, 16> worklist;
+  for (const auto* callback : {typeart_alloc.f, typeart_alloc_stack.f, typeart_alloc_global.f, typeart_alloc_omp.f,
+                               typeart_alloc_stacks_omp.f}) {
+    if (callback == nullptr) {
+      continue;
+    }
+    for (const auto* user : callback->users()) {
+      if (const auto* call = dyn_cast<CallBase>(user); call != nullptr) {
+        if (const auto* type_id = dyn_cast<ConstantInt>(call->getArgOperand(1)); type_id != nullptr) {
+          worklist.push_back(static_cast<int>(type_id->getSExtValue()));
+        }
+      }
+    }
+  }
+
+  // ... and the struct types of their members:
+  const auto& type_db = typeManager->getTypeDatabase();
+  llvm::DenseSet<int> visited;
+  std::vector<StructTypeInfo> types;
+  while (!worklist.empty()) {
+    const int type_id = worklist.pop_back_val();
+    const auto* info  = type_db.getStructInfo(type_id);
+    if (info == nullptr || !visited.insert(type_id).second) {
+      continue;
+    }
+    types.push_back(*info);
+    worklist.append(info->member_types.begin(), info->member_types.end());
+  }
+
+  llvm::sort(types, [](const auto& lhs, const auto& rhs) { return lhs.type_id < rhs.type_id; });
+  return types;
+}
+
 void TypeArtPass::printStats(llvm::raw_ostream& out) {
   meminst_finder->printStats(out);
 
@@ -21,6 +21,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace llvm {
 class Module;
@@ -32,6 +33,7 @@ class raw_ostream;
 
 namespace typeart {
 class TypeGenerator;
+struct StructTypeInfo;
 
 namespace analysis {
 class MemInstFinder;
@@ -55,6 +57,7 @@ class TypeArtPass : public llvm::ModulePass {
   TypeArtFunc typeart_alloc_stack{"__typeart_alloc_stack"};
   TypeArtFunc typeart_free{"__typeart_free"};
   TypeArtFunc typeart_leave_scope{"__typeart_leave_scope"};
+  TypeArtFunc typeart_register_types{"__typeart_register_types"};
 
   TypeArtFunc typeart_alloc_omp        = typeart_alloc;
   TypeArtFunc typeart_alloc_stacks_omp = typeart_alloc_stack;
@@ -79,6 +82,9 @@ class TypeArtPass : public llvm::ModulePass {
 
  private:
   void declareInstrumentationFunctions(llvm::Module&);
+  llvm::Function* declareTypeRegistration(llvm::Module&);
+  void defineTypeRegistration(llvm::Module&, llvm::Function&);
+  std::vector<StructTypeInfo> collectModuleTypes() const;
   void printStats(llvm::raw_ostream&);
 };
 
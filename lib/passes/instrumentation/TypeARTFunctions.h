@@ -40,6 +40,7 @@ enum class IFunc : unsigned {
   stack_omp,
   free_omp,
   scope_omp,
+  register_types,
 };
 
 class TAFunctionQuery {
@@ -27,6 +27,16 @@ class DataLayout;
 
 namespace typeart {
 
+enum class TypeIdScheme {
+  sequential,  // IDs in order of registration, consistent across modules only with a shared type file
+  hash         // IDs derived from the name and layout of a type, independent of other modules
+};
+
+enum class TypeStore {
+  file,    // The type file is read and rewritten as a whole by each module
+  journal  // Each module appends its new types to a locked type journal
+};
+
 class TypeGenerator {
  public:
   [[nodiscard]] virtual int getOrRegisterType(llvm::Type* type, const llvm::DataLayout& layout) = 0;
@@ -43,7 +53,10 @@ class TypeGenerator {
 };
 
 // This doesn't immediately load the file, call load/store after
-std::unique_ptr<TypeGenerator> make_typegen(const std::string& file);
+// The seed of hashed IDs (TypeIdScheme::hash) must be the same for all modules
+std::unique_ptr<TypeGenerator> make_typegen(const std::string& file,
+                                            TypeIdScheme scheme = TypeIdScheme::sequential,
+                                            TypeStore store = TypeStore::file, unsigned id_seed = 0);
 
 }  // namespace typeart
 
@@ -28,15 +28,21 @@
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/TypeSize.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
 
 #include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <string>
 #include <utility>
 #include <vector>
 
 namespace typeart {
 
-std::unique_ptr<TypeGenerator> make_typegen(const std::string& file) {
-  return std::make_unique<TypeManager>(file);
+std::unique_ptr<TypeGenerator> make_typegen(const std::string& file, TypeIdScheme scheme, TypeStore store,
+                                            unsigned id_seed) {
+  return std::make_unique<TypeManager>(file, scheme, store, id_seed);
 }
 
 using namespace llvm;
@@ -100,8 +106,6 @@ int TypeManager::getOrRegisterVector(llvm::VectorType* type, const llvm::DataLay
     return TYPEART_UNKNOWN_TYPE;
   }
 
-  const int id = reserveNextId();
-
   const auto [element_id, element_type, element_name] = element_data.getValue();
   const auto [vector_name, vector_bytes, vector_size] = vector_data.getValue();
 
@@ -120,14 +124,20 @@ int TypeManager::getOrRegisterVector(llvm::VectorType* type, const llvm::DataLay
     offsets.push_back(usableBytes);
   }
 
-  StructTypeInfo vecTypeInfo{id,      vector_name,   vector_bytes, memberTypeIDs.size(),
-                             offsets, memberTypeIDs, arraySizes,   StructTypeFlag::LLVM_VECTOR};
+  StructTypeInfo vecTypeInfo{TYPEART_UNKNOWN_TYPE, vector_name, vector_bytes, memberTypeIDs.size(), offsets,
+                             memberTypeIDs,        arraySizes,  StructTypeFlag::LLVM_VECTOR};
+  const int id        = scheme == TypeIdScheme::hash ? reserveHashedId(vecTypeInfo) : reserveNextId();
+  vecTypeInfo.type_id = id;
   typeDB.registerStruct(vecTypeInfo);
   structMap.insert({vector_name, id});
   return id;
 }
 
-TypeManager::TypeManager(std::string file) : file(std::move(file)), structCount(0) {
+TypeManager::TypeManager(std::string file, TypeIdScheme id_scheme, TypeStore store, unsigned id_seed)
+    : file(std::move(file)), structCount(0), scheme(id_scheme), idSeed(id_seed) {
+  if (store == TypeStore::journal) {
+    journal = std::make_unique<io::TypeJournal>(this->file);
+  }
 }
 
 const TypeDatabase& TypeManager::getTypeDatabase() const {
@@ -135,6 +145,12 @@ const TypeDatabase& TypeManager::getTypeDatabase() const {
 }
 
 std::pair<bool, std::error_code> TypeManager::load() {
+  if (journal && scheme == TypeIdScheme::sequential) {
+    // Sequential IDs continue the journal, no other module may append until this module is stored:
+    if (const auto ec = journal->lock(); ec) {
+      return {false, ec};
+    }
+  }
   //  TypeIO cio(&typeDB);
   // std::error_code error;
   auto loaded        = io::load(&typeDB, file);
@@ -146,11 +162,23 @@ std::pair<bool, std::error_code> TypeManager::load() {
   for (const auto& structInfo : typeDB.getStructList()) {
     structMap.insert({structInfo.name, structInfo.type_id});
   }
-  structCount = structMap.size();
+  structCount    = structMap.size();
+  journaledCount = typeDB.getNumStructs();
   return {true, ec};
 }
 
 std::pair<bool, std::error_code> TypeManager::store() const {
+  if (journal) {
+    // Appends only the types of this module:
+    const auto& types = typeDB.getStructList();
+    const std::vector<StructTypeInfo> new_types(types.begin() + journaledCount, types.end());
+    std::error_code ec = journal->lock();
+    if (!ec) {
+      ec = journal->append(new_types);
+    }
+    journal->unlock();
+    return {!static_cast<bool>(ec), ec};
+  }
   auto stored        = io::store(&typeDB, file);
   std::error_code ec = stored.getError();
   return {!static_cast<bool>(ec), ec};
@@ -231,8 +259,10 @@ int TypeManager::getOrRegisterStruct(llvm::StructType* type, const llvm::DataLay
 
   const auto name = handle.getName();
 
-  // Get next ID and register struct:
-  const int id = reserveNextId();
+  // Get next ID and register struct, a hashed ID depends on the member IDs and is derived after collecting them:
+  const bool hashed_id = scheme == TypeIdScheme::hash;
+  int id               = hashed_id ? TYPEART_UNKNOWN_TYPE : reserveNextId();
+  std::vector<size_t> self_members;
 
   size_t n = type->getStructNumElements();
 
@@ -256,6 +286,7 @@ int TypeManager::getOrRegisterStruct(llvm::StructType* type, const llvm::DataLay
     if (memberType->isStructTy()) {
       if (StructTypeHandler::getName(llvm::dyn_cast<StructType>(memberType)) == name) {
         memberID = id;
+        self_members.push_back(i);
       } else {
         memberID = getOrRegisterType(memberType, dl);
       }
@@ -279,6 +310,13 @@ int TypeManager::getOrRegisterStruct(llvm::StructType* type, const llvm::DataLay
   size_t numBytes = layout->getSizeInBytes();
 
   StructTypeInfo structInfo{id, name, numBytes, n, offsets, memberTypeIDs, arraySizes, StructTypeFlag::USER_DEFINED};
+  if (hashed_id) {
+    id                 = reserveHashedId(structInfo);
+    structInfo.type_id = id;
+    for (const auto member : self_members) {
+      structInfo.member_types[member] = id;
+    }
+  }
   typeDB.registerStruct(structInfo);
 
   structMap.insert({name, id});
@@ -291,4 +329,29 @@ int TypeManager::reserveNextId() {
   return id;
 }
 
+int TypeManager::reserveHashedId(const StructTypeInfo& info) const {
+  // Canonical form of the type, members refer to other structs by their (hashed) ID:
+  std::string canonical;
+  llvm::raw_string_ostream stream(canonical);
+  stream << info.name << '|' << info.extent << '|' << static_cast<int>(info.flag);
+  for (size_t index = 0; index < info.num_members; ++index) {
+    stream << '|' << info.offsets[index] << ':' << info.member_types[index] << ':' << info.array_sizes[index];
+  }
+  stream.flush();
+
+  constexpr auto num_ids =
+      static_cast<uint64_t>(std::numeric_limits<int>::max()) - static_cast<uint64_t>(TYPEART_NUM_RESERVED_IDS) + 1;
+  // The ID must not depend on the types known to this module (e.g., by probing another ID on a collision), as the
+  // type would get different IDs in modules compiled separately. A collision is resolved with a different seed of all
+  // modules instead:
+  const auto hash = llvm::xxHash64(idSeed == 0 ? canonical : canonical + '#' + std::to_string(idSeed));
+  const int id    = static_cast<int>(TYPEART_NUM_RESERVED_IDS + hash % num_ids);
+  if (typeDB.isValid(id)) {
+    LOG_FATAL("Type ID collision of " << info.name << " with " << typeDB.getTypeName(id) << " (ID " << id
+                                      << "). Compile all modules with a different -typeart-type-id-seed.");
+    std::exit(1);
+  }
+  return id;
+}
+
 }  // namespace typeart
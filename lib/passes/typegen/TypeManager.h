@@ -15,10 +15,12 @@
 
 #include "TypeGenerator.h"
 #include "typelib/TypeDB.h"
+#include "typelib/TypeJournal.h"
 
 #include "llvm/ADT/StringMap.h"
 
 #include <cstddef>
+#include <memory>
 #include <string>
 
 namespace llvm {
@@ -35,9 +37,15 @@ class TypeManager final : public TypeGenerator {
   TypeDB typeDB;
   llvm::StringMap<int> structMap;
   size_t structCount;
+  TypeIdScheme scheme;
+  unsigned idSeed;
+  // Only set for TypeStore::journal, types up to journaledCount are already in the journal:
+  std::unique_ptr<io::TypeJournal> journal;
+  size_t journaledCount{0};
 
  public:
-  explicit TypeManager(std::string file);
+  explicit TypeManager(std::string file, TypeIdScheme id_scheme = TypeIdScheme::sequential,
+                       TypeStore store = TypeStore::file, unsigned id_seed = 0);
   [[nodiscard]] std::pair<bool, std::error_code> load() override;
   [[nodiscard]] std::pair<bool, std::error_code> store() const override;
   [[nodiscard]] int getOrRegisterType(llvm::Type* type, const llvm::DataLayout& dl) override;
@@ -48,6 +56,7 @@ class TypeManager final : public TypeGenerator {
   [[nodiscard]] int getOrRegisterStruct(llvm::StructType* type, const llvm::DataLayout& dl);
   [[nodiscard]] int getOrRegisterVector(llvm::VectorType* type, const llvm::DataLayout& dl);
   [[nodiscard]] int reserveNextId();
+  [[nodiscard]] int reserveHashedId(const StructTypeInfo& info) const;
 };
 
 }  // namespace typeart
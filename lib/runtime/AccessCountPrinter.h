@@ -14,10 +14,13 @@
 #define TYPEART_ACCESSCOUNTPRINTER_H
 
 #include "AccessCounter.h"
+#include "CallSiteTable.h"
+#include "LookupCache.h"
 #include "support/Logger.h"
 #include "support/Table.h"
 
 #include <fstream>
+#include <iomanip>
 #include <map>
 #include <set>
 #include <sstream>
@@ -28,6 +31,17 @@
 #include <utility>
 
 namespace typeart::softcounter {
+namespace detail {
+inline Row make_distinct_row(std::string name, const DistinctCount& distinct) {
+  if (distinct.exact) {
+    return Row::make(std::move(name), distinct.count);
+  }
+  std::ostringstream bound;
+  bound << "+/-" << std::setprecision(1) << std::fixed << distinct.error_bound * 100.0 << "%";
+  return Row::make(std::move(name), distinct.count, bound.str());
+}
+}  // namespace detail
+
 namespace memory {
 struct MemOverhead {
   static constexpr auto pointerMapSize = sizeof(RuntimeT::PointerMap);  // Map overhead
@@ -35,16 +49,21 @@ struct MemOverhead {
       64U + sizeof(RuntimeT::MapEntry);  // rough estimate, not applicable to btree; 64U is internal node size
   static constexpr auto stackVectorSize  = sizeof(RuntimeT::Stack);       // Stack overhead
   static constexpr auto perNodeSizeStack = sizeof(RuntimeT::StackEntry);  // Stack allocs
+  static constexpr auto perCallSiteSize =
+      sizeof(MemAddr) + 16U + sizeof(std::pair<MemAddr, uint32_t>);  // rough estimate, site vector and hash node
   double stack{0};
   double map{0};
 };
-inline MemOverhead estimate(Counter stack_max, Counter heap_max, Counter global_max, const double scale = 1024.0) {
+inline MemOverhead estimate(Counter stack_max, Counter heap_max, Counter global_max, size_t call_sites = 0,
+                            const double scale = 1024.0) {
   MemOverhead mem;
   mem.stack = double(MemOverhead::stackVectorSize +
                      MemOverhead::perNodeSizeStack * std::max<size_t>(RuntimeT::StackReserve, stack_max)) /
               scale;
   mem.map =
-      double(MemOverhead::pointerMapSize + MemOverhead::perNodeSizeMap * (stack_max + heap_max + global_max)) / scale;
+      double(MemOverhead::pointerMapSize + MemOverhead::perNodeSizeMap * (stack_max + heap_max + global_max) +
+             MemOverhead::perCallSiteSize * call_sites) /
+      scale;
   return mem;
 }
 }  // namespace memory
@@ -54,7 +73,13 @@ void serialize(const Recorder& r, std::ostringstream& buf) {
   if constexpr (std::is_same_v<Recorder, NoneRecorder>) {
     return;
   } else {
-    const auto memory_use = memory::estimate(r.getMaxStackAllocs(), r.getMaxHeapAllocs(), r.getGlobalAllocs());
+#ifdef TYPEART_COMPACT_POINTER_INFO
+    const size_t call_sites = CallSiteTable::get().size();
+#else
+    const size_t call_sites = 0;
+#endif
+    const auto memory_use =
+        memory::estimate(r.getMaxStackAllocs(), r.getMaxHeapAllocs(), r.getGlobalAllocs(), call_sites);
 
     Table t("Alloc Stats from softcounters");
     t.wrap_length = true;
@@ -64,18 +89,24 @@ void serialize(const Recorder& r, std::ostringstream& buf) {
     t.put(Row::make("Max. Heap Allocs", r.getMaxHeapAllocs()));
     t.put(Row::make("Max. Stack Allocs", r.getMaxStackAllocs()));
     t.put(Row::make("Addresses checked", r.getAddrChecked()));
-    t.put(Row::make("Distinct Addresses checked", r.getSeen().size()));
+    t.put(detail::make_distinct_row("Distinct Addresses checked", r.getDistinctSeen()));
     t.put(Row::make("Addresses re-used", r.getAddrReuses()));
     t.put(Row::make("Addresses missed", r.getAddrMissing()));
-    t.put(Row::make("Distinct Addresses missed", r.getMissing().size()));
+    t.put(detail::make_distinct_row("Distinct Addresses missed", r.getDistinctMissing()));
     t.put(Row::make("Total free heap", r.getHeapAllocsFree(), r.getHeapArrayFree()));
     t.put(Row::make("Total free stack", r.getStackAllocsFree(), r.getStackArrayFree()));
     t.put(Row::make("OMP Stack/Heap/Free", r.getOmpStackCalls(), r.getOmpHeapCalls(), r.getOmpFreeCalls()));
+    if constexpr (ThreadLookupCache::enabled) {
+      t.put(Row::make("Lookup cache hits/misses", r.getLookupCacheHits(), r.getLookupCacheMisses()));
+    }
     t.put(Row::make("Null/Zero/NullZero Addr", r.getNullAlloc(), r.getZeroAlloc(), r.getNullAndZeroAlloc()));
     t.put(Row::make("User-def. types", r.getNumUDefTypes()));
     t.put(Row::make("Estimated memory use (KiB)", size_t(std::round(memory_use.map + memory_use.stack))));
     t.put(Row::make("Bytes per node map/stack", memory::MemOverhead::perNodeSizeMap,
                     memory::MemOverhead::perNodeSizeStack));
+#ifdef TYPEART_COMPACT_POINTER_INFO
+    t.put(Row::make("Distinct call sites", call_sites));
+#endif
 
     t.print(buf);
 
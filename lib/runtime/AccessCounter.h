@@ -13,13 +13,18 @@
 #ifndef TYPEART_ACCESSCOUNTER_H
 #define TYPEART_ACCESSCOUNTER_H
 
+#include "DistinctCounter.h"
 #include "RuntimeData.h"
 #include "RuntimeInterface.h"
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <cmath>
+#include <cstdint>
 #include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <numeric>
 #include <set>
@@ -35,6 +40,8 @@ namespace typeart {
 
 namespace softcounter {
 
+class AccessRecorder;
+
 using Counter       = long long int;
 using AtomicCounter = std::atomic<Counter>;
 
@@ -84,41 +91,123 @@ struct CounterStats {
 }  // namespace detail
 
 namespace thread {
+/**
+ * A counter written by its owning thread only, hence no atomic read-modify-write is required. Other threads may read it
+ * at any time (relaxed), e.g., when the counters are merged for serialization.
+ */
+class LocalCounter {
+  std::atomic<Counter> value{0};
+
+ public:
+  inline LocalCounter& operator+=(Counter amount) noexcept {
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    return *this;
+  }
+
+  inline LocalCounter& operator-=(Counter amount) noexcept {
+    return *this += -amount;
+  }
+
+  inline LocalCounter& operator++() noexcept {
+    return *this += 1;
+  }
+
+  inline Counter load() const noexcept {
+    return value.load(std::memory_order_relaxed);
+  }
+
+  inline operator Counter() const noexcept {  // NOLINT(google-explicit-constructor)
+    return load();
+  }
+};
+
+/**
+ * Per-type counts of a thread. Type IDs below DenseIds (all built-in and the common user-defined IDs) are counted in
+ * place, other (e.g., hashed) IDs fall back to a map. The map is guarded by an (owner-only, hence uncontended) mutex.
+ */
+class TypeCounts {
+ public:
+  static constexpr int DenseIds = 1024;
+
+  inline void inc(int typeId) {
+    if (typeId >= 0 && typeId < DenseIds) {
+      ++dense[typeId];
+      return;
+    }
+    std::lock_guard lock(sparseMutex);
+    ++sparse[typeId];
+  }
+
+  void mergeInto(std::unordered_map<int, Counter>& counts) const {
+    for (int typeId = 0; typeId < DenseIds; ++typeId) {
+      if (const Counter count = dense[typeId]; count != 0) {
+        counts[typeId] += count;
+      }
+    }
+    std::lock_guard lock(sparseMutex);
+    for (const auto& [typeId, count] : sparse) {
+      counts[typeId] += count;
+    }
+  }
+
+ private:
+  std::array<LocalCounter, DenseIds> dense{};
+  std::unordered_map<int, Counter> sparse;
+  mutable std::mutex sparseMutex;
+};
+
+/**
+ * Counter block of a single thread, see AccessRecorder::getCurrentThreadRecorder.
+ */
 class ThreadRecorder {
-  friend class AccessRecorder;
+  friend class typeart::softcounter::AccessRecorder;
 
  public:
-  inline void incHeapAlloc(size_t count) {
+  inline void incHeapAlloc(int typeId, size_t count) {
     ++heapAllocs;
     if (count > 1) {
-      heapArray++;
+      ++heapArray;
     }
+    heapAlloc.inc(typeId);
   }
 
-  inline void incHeapFree(size_t count) {
+  inline void incHeapFree(int typeId, size_t count) {
     ++heapAllocsFree;
     if (count > 1) {
       ++heapArrayFree;
     }
+    heapFree.inc(typeId);
   }
 
-  inline void incStackAlloc(size_t count) {
+  inline void incStackAlloc(int typeId, size_t count) {
     ++curStackAllocs;
     ++stackAllocs;
     if (count > 1) {
       ++stackArray;
     }
+    stackAlloc.inc(typeId);
   }
 
-  inline void incStackFree(size_t count) {
+  inline void incStackFree(int typeId, size_t count) {
     ++stackAllocsFree;
     if (count > 1) {
       ++stackArrayFree;
     }
+    stackFree.inc(typeId);
+  }
+
+  inline void incGlobalAlloc(int typeId, size_t count) {
+    ++globalAllocs;
+    if (count > 1) {
+      ++globalArray;
+    }
+    globalAlloc.inc(typeId);
   }
 
   inline void decStackAlloc(size_t amount) {
-    detail::updateMax(maxStackAllocs, curStackAllocs.load());
+    if (curStackAllocs > maxStackAllocs) {
+      maxStackAllocs += curStackAllocs - maxStackAllocs;
+    }
     curStackAllocs -= amount;
   }
 
@@ -169,26 +258,60 @@ class ThreadRecorder {
   }
 
  private:
-  AtomicCounter heapAllocs      = 0;
-  AtomicCounter heapArray       = 0;
-  AtomicCounter heapAllocsFree  = 0;
-  AtomicCounter heapArrayFree   = 0;
-  AtomicCounter stackAllocs     = 0;
-  AtomicCounter curStackAllocs  = 0;
-  AtomicCounter maxStackAllocs  = 0;
-  AtomicCounter stackArray      = 0;
-  AtomicCounter stackAllocsFree = 0;
-  AtomicCounter stackArrayFree  = 0;
+  LocalCounter heapAllocs;
+  LocalCounter heapArray;
+  LocalCounter heapAllocsFree;
+  LocalCounter heapArrayFree;
+  LocalCounter stackAllocs;
+  LocalCounter curStackAllocs;
+  LocalCounter maxStackAllocs;
+  LocalCounter stackArray;
+  LocalCounter stackAllocsFree;
+  LocalCounter stackArrayFree;
+  LocalCounter globalAllocs;
+  LocalCounter globalArray;
+  LocalCounter addrChecked;
+  LocalCounter addrReuses;
+  LocalCounter addrMissing;
+  LocalCounter nullAlloc;
+  LocalCounter zeroAlloc;
+  LocalCounter nullAndZeroAlloc;
+  LocalCounter omp_stack;
+  LocalCounter omp_heap;
+  LocalCounter omp_heap_free;
+  LocalCounter lookupCacheHits;
+  LocalCounter lookupCacheMisses;
+
+  TypeCounts heapAlloc;
+  TypeCounts stackAlloc;
+  TypeCounts globalAlloc;
+  TypeCounts heapFree;
+  TypeCounts stackFree;
 };
 
 }  // namespace thread
 
+/**
+ * Each thread counts into its own ThreadRecorder block, registered once on the first event of the thread. Blocks are
+ * owned by the recorder (they outlive their thread) and are only merged when values are queried, e.g., by serialize.
+ * The live heap allocation count and its maximum are program-wide and, hence, kept as shared atomics.
+ */
 class AccessRecorder {
  public:
   using TypeCountMap      = std::unordered_map<int, Counter>;
-  using AddressSet        = std::unordered_set<MemAddr>;
+  using AddressSet        = DistinctCounter::AddressSet;
   using MutexT            = std::shared_mutex;
-  using ThreadRecorderMap = std::unordered_map<std::thread::id, thread::ThreadRecorder>;
+  using ThreadRecorderMap = std::unordered_map<std::thread::id, std::unique_ptr<thread::ThreadRecorder>>;
+
+  AccessRecorder() : AccessRecorder(DistinctConfig::fromEnv()) {
+  }
+
+  explicit AccessRecorder(const DistinctConfig& distinct) : seen(distinct), missing(distinct) {
+  }
+
+  AccessRecorder(const AccessRecorder&) = delete;
+
+  AccessRecorder& operator=(const AccessRecorder&) = delete;
 
   ~AccessRecorder() = default;
 
@@ -199,63 +322,23 @@ class AccessRecorder {
     // A program without free would otherwise never update maxHeap (see test 20_softcounter_max)
     detail::updateMax(maxHeapAllocs, curHeapAllocs.load());
 
-    ++heapAllocs;
-    if (count > 1) {
-      ++heapArray;
-    }
-
-    {
-      std::lock_guard threadRecorderGuard(threadRecorderMutex);
-      getCurrentThreadRecorder().incHeapAlloc(count);
-    }
-
-    std::lock_guard lock(heapAllocMutex);
-    ++heapAlloc[typeId];
+    getCurrentThreadRecorder().incHeapAlloc(typeId, count);
   }
 
   inline void incStackAlloc(int typeId, size_t count) {
-    {
-      std::lock_guard threadRecorderGuard(threadRecorderMutex);
-      getCurrentThreadRecorder().incStackAlloc(count);
-    }
-
-    std::lock_guard lock(stackAllocMutex);
-    ++stackAlloc[typeId];
+    getCurrentThreadRecorder().incStackAlloc(typeId, count);
   }
 
   inline void incGlobalAlloc(int typeId, size_t count) {
-    ++globalAllocs;
-    if (count > 1) {
-      ++globalArray;
-    }
-
-    std::lock_guard lock(globalAllocMutex);
-    ++globalAlloc[typeId];
+    getCurrentThreadRecorder().incGlobalAlloc(typeId, count);
   }
 
   inline void incStackFree(int typeId, size_t count) {
-    {
-      std::lock_guard threadRecorderGuard(threadRecorderMutex);
-      getCurrentThreadRecorder().incStackFree(count);
-    }
-
-    std::lock_guard lock(stackFreeMutex);
-    ++stackFree[typeId];
+    getCurrentThreadRecorder().incStackFree(typeId, count);
   }
 
   inline void incHeapFree(int typeId, size_t count) {
-    ++heapAllocsFree;
-    if (count > 1) {
-      ++heapArrayFree;
-    }
-
-    {
-      std::lock_guard threadRecorderGuard(threadRecorderMutex);
-      getCurrentThreadRecorder().incHeapFree(count);
-    }
-
-    std::lock_guard lock(heapFreeMutex);
-    ++heapFree[typeId];
+    getCurrentThreadRecorder().incHeapFree(typeId, count);
   }
 
   inline void decHeapAlloc() {
@@ -267,40 +350,33 @@ class AccessRecorder {
   }
 
   inline void decStackAlloc(size_t amount) {
-    {
-      std::lock_guard threadRecorderGuard(threadRecorderMutex);
-      getCurrentThreadRecorder().decStackAlloc(amount);
-    }
+    getCurrentThreadRecorder().decStackAlloc(amount);
   }
 
   inline void incUsedInRequest(MemAddr addr) {
-    ++addrChecked;
-
-    std::lock_guard lock(seenMutex);
-    seen.insert(addr);
+    ++getCurrentThreadRecorder().addrChecked;
+    seen.add(addr);
   }
 
   inline void incAddrReuse() {
-    ++addrReuses;
+    ++getCurrentThreadRecorder().addrReuses;
   }
 
   inline void incAddrMissing(MemAddr addr) {
-    ++addrMissing;
-
-    std::lock_guard lock(missingMutex);
-    missing.insert(addr);
+    ++getCurrentThreadRecorder().addrMissing;
+    missing.add(addr);
   }
 
   inline void incNullAddr() {
-    ++nullAlloc;
+    ++getCurrentThreadRecorder().nullAlloc;
   }
 
   inline void incZeroLengthAddr() {
-    ++zeroAlloc;
+    ++getCurrentThreadRecorder().zeroAlloc;
   }
 
   inline void incZeroLengthAndNullAddr() {
-    ++nullAndZeroAlloc;
+    ++getCurrentThreadRecorder().nullAndZeroAlloc;
   }
 
   inline void incUDefTypes(size_t count) {
@@ -308,25 +384,33 @@ class AccessRecorder {
   }
 
   inline void incOmpContextStack() {
-    ++omp_stack;
+    ++getCurrentThreadRecorder().omp_stack;
   }
 
   inline void incOmpContextHeap() {
-    ++omp_heap;
+    ++getCurrentThreadRecorder().omp_heap;
   }
 
   inline void incOmpContextFree() {
-    ++omp_heap_free;
+    ++getCurrentThreadRecorder().omp_heap_free;
+  }
+
+  inline void incLookupCacheHit() {
+    ++getCurrentThreadRecorder().lookupCacheHits;
+  }
+
+  inline void incLookupCacheMiss() {
+    ++getCurrentThreadRecorder().lookupCacheMisses;
   }
 
   Counter getHeapAllocs() const {
-    return heapAllocs;
+    return getHeapAllocsThreadStats().sum;
   }
   Counter getStackAllocs() const {
     return getStackAllocsThreadStats().sum;
   }
   Counter getGlobalAllocs() const {
-    return globalAllocs;
+    return sum(&thread::ThreadRecorder::globalAllocs);
   }
   Counter getMaxHeapAllocs() const {
     return maxHeapAllocs;
@@ -338,22 +422,22 @@ class AccessRecorder {
     return curHeapAllocs;
   }
   Counter getAddrReuses() const {
-    return addrReuses;
+    return sum(&thread::ThreadRecorder::addrReuses);
   }
   Counter getAddrMissing() const {
-    return addrMissing;
+    return sum(&thread::ThreadRecorder::addrMissing);
   }
   Counter getAddrChecked() const {
-    return addrChecked;
+    return sum(&thread::ThreadRecorder::addrChecked);
   }
   Counter getStackArray() const {
     return getStackArrayThreadStats().sum;
   }
   Counter getHeapArray() const {
-    return heapArray;
+    return getHeapArrayThreadStats().sum;
   }
   Counter getGlobalArray() const {
-    return globalArray;
+    return sum(&thread::ThreadRecorder::globalArray);
   }
   Counter getStackAllocsFree() const {
     return getStackAllocsFreeThreadStats().sum;
@@ -362,39 +446,53 @@ class AccessRecorder {
     return getStackArrayFreeThreadStats().sum;
   }
   Counter getHeapAllocsFree() const {
-    return heapAllocsFree;
+    return getHeapAllocsFreeThreadStats().sum;
   }
   Counter getHeapArrayFree() const {
-    return heapArrayFree;
+    return getHeapArrayFreeThreadStats().sum;
   }
   Counter getNullAlloc() const {
-    return nullAlloc;
+    return sum(&thread::ThreadRecorder::nullAlloc);
   }
   Counter getZeroAlloc() const {
-    return zeroAlloc;
+    return sum(&thread::ThreadRecorder::zeroAlloc);
   }
   Counter getNullAndZeroAlloc() const {
-    return nullAndZeroAlloc;
+    return sum(&thread::ThreadRecorder::nullAndZeroAlloc);
   }
   Counter getNumUDefTypes() const {
     return numUDefTypes;
   }
   Counter getOmpHeapCalls() const {
-    return omp_heap;
+    return sum(&thread::ThreadRecorder::omp_heap);
   }
   Counter getOmpFreeCalls() const {
-    return omp_heap_free;
+    return sum(&thread::ThreadRecorder::omp_heap_free);
   }
   Counter getOmpStackCalls() const {
-    return omp_stack;
+    return sum(&thread::ThreadRecorder::omp_stack);
+  }
+  Counter getLookupCacheHits() const {
+    return sum(&thread::ThreadRecorder::lookupCacheHits);
   }
+  Counter getLookupCacheMisses() const {
+    return sum(&thread::ThreadRecorder::lookupCacheMisses);
+  }
+
   /**
-   * Must be locked by the caller.
-   * @return
+   * Returns the counter block of the calling thread. Only the first call of a thread (per recorder) locks, to register
+   * the block, subsequent calls are served by a thread-local pointer.
    */
   inline thread::ThreadRecorder& getCurrentThreadRecorder() {
-    const auto tid = std::this_thread::get_id();
-    return threadRecorders[tid];
+    struct CurrentBlock {
+      uint64_t recorder{0};
+      thread::ThreadRecorder* block{nullptr};
+    };
+    static thread_local CurrentBlock current;
+    if (current.recorder != instanceId) {
+      current = CurrentBlock{instanceId, &registerCurrentThread()};
+    }
+    return *current.block;
   }
 
 #define THREAD_VALS_GETTER_FN(COUNTER_NAME)                    \
@@ -403,7 +501,7 @@ class AccessRecorder {
     std::vector<Counter> vals;                                 \
     vals.reserve(threadRecorders.size());                      \
     for (const auto& [id, r] : threadRecorders) {              \
-      vals.push_back(r.get##COUNTER_NAME());                   \
+      vals.push_back(r->get##COUNTER_NAME());                  \
     }                                                          \
     return vals;                                               \
   }
@@ -437,33 +535,38 @@ class AccessRecorder {
 
 #undef THREADS_STATS_GETTER_FN
 
+  DistinctCount getDistinctMissing() const {
+    return missing.count();
+  }
+  DistinctCount getDistinctSeen() const {
+    return seen.count();
+  }
+  /**
+   * @return the missed addresses, only recorded when counting exactly (see DistinctConfig).
+   */
   AddressSet getMissing() const {
-    std::shared_lock slock(missingMutex);
-    return missing;
+    return missing.values();
   }
+  /**
+   * @return the checked addresses, only recorded when counting exactly (see DistinctConfig).
+   */
   AddressSet getSeen() const {
-    std::shared_lock slock(seenMutex);
-    return seen;
+    return seen.values();
   }
   TypeCountMap getStackAlloc() const {
-    std::shared_lock slock(stackAllocMutex);
-    return stackAlloc;
+    return merge(&thread::ThreadRecorder::stackAlloc);
   }
   TypeCountMap getHeapAlloc() const {
-    std::shared_lock slock(heapAllocMutex);
-    return heapAlloc;
+    return merge(&thread::ThreadRecorder::heapAlloc);
   }
   TypeCountMap getGlobalAlloc() const {
-    std::shared_lock slock(globalAllocMutex);
-    return globalAlloc;
+    return merge(&thread::ThreadRecorder::globalAlloc);
   }
   TypeCountMap getStackFree() const {
-    std::shared_lock slock(stackFreeMutex);
-    return stackFree;
+    return merge(&thread::ThreadRecorder::stackFree);
   }
   TypeCountMap getHeapFree() const {
-    std::shared_lock slock(heapFreeMutex);
-    return heapFree;
+    return merge(&thread::ThreadRecorder::heapFree);
   }
 
   std::vector<std::thread::id> getThreadIds() const {
@@ -480,49 +583,50 @@ class AccessRecorder {
   }
 
  private:
-  AtomicCounter heapAllocs       = 0;
-  AtomicCounter globalAllocs     = 0;
-  AtomicCounter maxHeapAllocs    = 0;
-  AtomicCounter curHeapAllocs    = 0;
-  AtomicCounter addrReuses       = 0;
-  AtomicCounter addrMissing      = 0;
-  AtomicCounter addrChecked      = 0;
-  AtomicCounter heapArray        = 0;
-  AtomicCounter globalArray      = 0;
-  AtomicCounter heapAllocsFree   = 0;
-  AtomicCounter heapArrayFree    = 0;
-  AtomicCounter nullAlloc        = 0;
-  AtomicCounter zeroAlloc        = 0;
-  AtomicCounter nullAndZeroAlloc = 0;
-  AtomicCounter numUDefTypes     = 0;
-  AtomicCounter omp_stack        = 0;
-  AtomicCounter omp_heap         = 0;
-  AtomicCounter omp_heap_free    = 0;
-
-  //  ThreadRecorderMapSafe threadRecorders;
-  mutable MutexT threadRecorderMutex;
-  ThreadRecorderMap threadRecorders;
+  thread::ThreadRecorder& registerCurrentThread() {
+    std::lock_guard guard(threadRecorderMutex);
+    auto& block = threadRecorders[std::this_thread::get_id()];
+    if (!block) {
+      block = std::make_unique<thread::ThreadRecorder>();
+    }
+    return *block;
+  }
 
-  AddressSet missing;
-  mutable MutexT missingMutex;
+  Counter sum(thread::LocalCounter thread::ThreadRecorder::*counter) const {
+    std::shared_lock guard(threadRecorderMutex);
+    Counter total{0};
+    for (const auto& [id, r] : threadRecorders) {
+      total += ((*r).*counter).load();
+    }
+    return total;
+  }
 
-  AddressSet seen;
-  mutable MutexT seenMutex;
+  TypeCountMap merge(thread::TypeCounts thread::ThreadRecorder::*counts) const {
+    std::shared_lock guard(threadRecorderMutex);
+    TypeCountMap merged;
+    for (const auto& [id, r] : threadRecorders) {
+      ((*r).*counts).mergeInto(merged);
+    }
+    return merged;
+  }
 
-  TypeCountMap stackAlloc;
-  mutable MutexT stackAllocMutex;
+  static uint64_t nextInstanceId() {
+    static std::atomic<uint64_t> instances{0};
+    return ++instances;
+  }
 
-  TypeCountMap heapAlloc;
-  mutable MutexT heapAllocMutex;
+  // Distinguishes recorders in the thread-local block cache, (unlike the address) it is never reused.
+  const uint64_t instanceId{nextInstanceId()};
 
-  TypeCountMap globalAlloc;
-  mutable MutexT globalAllocMutex;
+  AtomicCounter maxHeapAllocs = 0;
+  AtomicCounter curHeapAllocs = 0;
+  AtomicCounter numUDefTypes  = 0;
 
-  TypeCountMap stackFree;
-  mutable MutexT stackFreeMutex;
+  mutable MutexT threadRecorderMutex;
+  ThreadRecorderMap threadRecorders;
 
-  TypeCountMap heapFree;
-  mutable MutexT heapFreeMutex;
+  DistinctCounter seen;
+  DistinctCounter missing;
 };
 
 /**
@@ -564,6 +668,10 @@ class NoneRecorder {
   }
   [[maybe_unused]] inline void incOmpContextFree() {
   }
+  [[maybe_unused]] inline void incLookupCacheHit() {
+  }
+  [[maybe_unused]] inline void incLookupCacheMiss() {
+  }
 };
 
 }  // namespace softcounter
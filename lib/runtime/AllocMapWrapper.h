@@ -14,12 +14,55 @@
 #define TYPEART_ALLOCMAPWRAPPER_H
 
 #include "RuntimeData.h"
+#include "ShadowTable.h"
+#include "TypeRegistry.h"
+
+#include "support/Logger.h"
 
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace typeart {
+
+/**
+ * Creates the map, passing the type database to those maps that need the type layouts (e.g., allocation extents).
+ */
+template <typename Map>
+[[nodiscard]] inline Map make_pointer_map(const TypeRegistry& types) {
+  if constexpr (std::is_constructible_v<Map, const TypeRegistry&>) {
+    return Map{types};
+  } else {
+    return Map{};
+  }
+}
+
+/**
+ * Result of inserting an entry: Whether an existing entry was overridden, and the closest entry preceding the new one
+ * (only within the shard of the new entry for ShardedMap::put, see mixin::put_with_previous).
+ */
+struct PutResult {
+  bool overridden{false};
+  llvm::Optional<RuntimeT::MapEntry> previous;
+};
+
 namespace mixin {
 enum class BulkOperation { remove = 0 };
 
@@ -45,27 +88,68 @@ template <typename Map>
 [[nodiscard]] inline PtrWrap<Map> as_ptr(Map& m) {
   return PtrWrap<Map>{m};
 }
+
+/**
+ * Counts the readers of one epoch. Readers are spread over cache-line sized stripes (by thread) to avoid readers
+ * bouncing a single shared counter.
+ */
+class ReadIndicator final {
+  static constexpr size_t NumStripes{32};
+
+  struct alignas(64) Stripe {
+    std::atomic<long> readers{0};
+  };
+
+  std::array<Stripe, NumStripes> stripes_;
+
+  [[nodiscard]] inline static size_t stripe_index() {
+    static std::atomic<size_t> next_index{0};
+    thread_local const size_t index = next_index.fetch_add(1, std::memory_order_relaxed) % NumStripes;
+    return index;
+  }
+
+ public:
+  inline void arrive() {
+    stripes_[stripe_index()].readers.fetch_add(1, std::memory_order_seq_cst);
+  }
+
+  inline void depart() {
+    stripes_[stripe_index()].readers.fetch_sub(1, std::memory_order_release);
+  }
+
+  [[nodiscard]] inline bool empty() const {
+    return std::all_of(stripes_.begin(), stripes_.end(),
+                       [](const auto& stripe) { return stripe.readers.load(std::memory_order_seq_cst) == 0; });
+  }
+};
 }  // namespace detail
 
-struct MapOp {
+template <typename Container = RuntimeT::PointerMap>
+struct BasicMapOp {
  private:
-  RuntimeT::PointerMap map_;
+  Container map_;
 
  public:
-  [[nodiscard]] const RuntimeT::PointerMap& map() const {
+  [[nodiscard]] const Container& map() const {
     return map_;
   }
 
-  [[nodiscard]] RuntimeT::PointerMap& map() {
+  [[nodiscard]] Container& map() {
     return map_;
   }
 
   template <typename PointerMap>
-  [[nodiscard]] inline static bool put(PointerMap&& xlocked_map, MemAddr addr, const RuntimeT::MappedType& data) {
-    auto& def             = (*xlocked_map)[addr];
-    const bool overridden = (def.typeId != -1);
-    def                   = data;
-    return overridden;
+  [[nodiscard]] inline static PutResult put(PointerMap&& xlocked_map, MemAddr addr, const RuntimeT::MappedType& data) {
+    PutResult result;
+    const auto [it, inserted] = xlocked_map->insert({addr, data});
+    if (!inserted) {
+      result.overridden = (it->second.typeId != -1);
+      it->second        = data;
+    }
+    if (it != xlocked_map->begin()) {
+      result.previous.emplace(*std::prev(it));
+    }
+    return result;
   }
 
   template <typename PointerMap>
@@ -99,9 +183,85 @@ struct MapOp {
     return llvm::None;
   }
 
+  /**
+   * Removes all addresses of [s, e) in a single, merged sweep over the (ordered) map.
+   * The addresses are sorted first, the callback is still invoked in the original order of the range.
+   */
+  template <typename PointerMap, typename FwdIter, typename Callback>
+  inline static void remove_sorted(PointerMap&& xlocked_map, FwdIter&& s, FwdIter&& e, Callback&& log) {
+    // Bounded forward walk between two consecutive addresses, before falling back to a new tree descent:
+    constexpr unsigned max_sweep_steps{8};
+
+    llvm::SmallVector<std::pair<MemAddr, size_t>, 16> sorted;
+    size_t index{0};
+    std::for_each(s, e, [&sorted, &index](MemAddr addr) { sorted.emplace_back(addr, index++); });
+    std::sort(sorted.begin(), sorted.end());
+
+    llvm::SmallVector<llvm::Optional<RuntimeT::MappedType>, 16> removed(sorted.size());
+    auto it = xlocked_map->lower_bound(sorted.front().first);
+    for (const auto& [addr, position] : sorted) {
+      unsigned steps{0};
+      while (it != xlocked_map->end() && it->first < addr) {
+        if (++steps > max_sweep_steps) {
+          it = xlocked_map->lower_bound(addr);
+          break;
+        }
+        ++it;
+      }
+      if (it != xlocked_map->end() && it->first == addr) {
+        removed[position] = it->second;
+        it                = xlocked_map->erase(it);
+      }
+    }
+
+    index = 0;
+    std::for_each(s, e, [&removed, &index, &log](MemAddr addr) { log(removed[index++], addr); });
+  }
+
+  /**
+   * Resolves the base addresses of all addresses of [s, e) in a single, merged sweep over the (ordered) map, see find.
+   * The callback is invoked in the original order of the range.
+   */
+  template <typename PointerMap, typename FwdIter, typename Callback>
+  inline static void find_sorted(PointerMap&& slocked_map, FwdIter&& s, FwdIter&& e, Callback&& found) {
+    constexpr unsigned max_sweep_steps{8};
+
+    llvm::SmallVector<std::pair<MemAddr, size_t>, 16> sorted;
+    size_t index{0};
+    std::for_each(s, e, [&sorted, &index](MemAddr addr) { sorted.emplace_back(addr, index++); });
+    std::sort(sorted.begin(), sorted.end());
+
+    std::vector<llvm::Optional<RuntimeT::MapEntry>> bases(sorted.size());
+    if (!sorted.empty() && !slocked_map->empty()) {
+      // Invariant: it is the first element greater than the current address, its predecessor is the base address.
+      auto it = slocked_map->upper_bound(sorted.front().first);
+      for (const auto& [addr, position] : sorted) {
+        unsigned steps{0};
+        while (it != slocked_map->end() && it->first <= addr) {
+          if (++steps > max_sweep_steps) {
+            it = slocked_map->upper_bound(addr);
+            break;
+          }
+          ++it;
+        }
+        if (it != slocked_map->begin()) {
+          bases[position].emplace(*std::prev(it));
+        }
+      }
+    }
+
+    index = 0;
+    std::for_each(s, e, [&bases, &index, &found](MemAddr addr) { found(bases[index++], addr); });
+  }
+
   template <BulkOperation Operation, typename PointerMap, typename FwdIter, typename Callback>
   inline static void bulk_op(PointerMap&& xlocked_map, FwdIter&& s, FwdIter&& e, Callback&& log) {
     if constexpr (Operation == BulkOperation::remove) {
+      if (std::distance(s, e) > 1) {
+        remove_sorted(std::forward<PointerMap>(xlocked_map), std::forward<FwdIter>(s), std::forward<FwdIter>(e),
+                      std::forward<Callback>(log));
+        return;
+      }
       std::for_each(s, e, [&xlocked_map, &log](MemAddr addr) {
         auto removed = remove(std::forward<PointerMap>(xlocked_map), addr);
         log(removed, addr);
@@ -112,13 +272,21 @@ struct MapOp {
   }
 };
 
+using MapOp = BasicMapOp<>;
+
 template <typename BaseOp>
 struct StandardMapBase : protected BaseOp {
   [[nodiscard]] inline llvm::Optional<RuntimeT::MapEntry> find(MemAddr addr) const {
     return BaseOp::find(detail::as_ptr(this->map()), addr);
   }
 
-  [[nodiscard]] inline bool put(MemAddr addr, const RuntimeT::MappedType& entry) {
+  template <typename FwdIter, typename Callback>
+  inline void find_range(FwdIter&& s, FwdIter&& e, Callback&& found) const {
+    BaseOp::find_sorted(detail::as_ptr(this->map()), std::forward<FwdIter>(s), std::forward<FwdIter>(e),
+                        std::forward<Callback>(found));
+  }
+
+  [[nodiscard]] inline PutResult put(MemAddr addr, const RuntimeT::MappedType& entry) {
     return BaseOp::put(detail::as_ptr(this->map()), addr, entry);
   }
 
@@ -139,12 +307,20 @@ struct SharedMutexMap : public BaseOp {
   mutable std::shared_mutex alloc_m;
 
  public:
+  using BaseOp::BaseOp;
+
   [[nodiscard]] inline llvm::Optional<RuntimeT::MapEntry> find(MemAddr addr) const {
     std::shared_lock<std::shared_mutex> guard(alloc_m);
     return BaseOp::find(addr);
   }
 
-  [[nodiscard]] inline bool put(MemAddr addr, const RuntimeT::MappedType& entry) {
+  template <typename FwdIter, typename Callback>
+  inline void find_range(FwdIter&& s, FwdIter&& e, Callback&& found) const {
+    std::shared_lock<std::shared_mutex> guard(alloc_m);
+    BaseOp::find_range(std::forward<FwdIter>(s), std::forward<FwdIter>(e), std::forward<Callback>(found));
+  }
+
+  [[nodiscard]] inline PutResult put(MemAddr addr, const RuntimeT::MappedType& entry) {
     std::lock_guard<std::shared_mutex> guard(alloc_m);
     return BaseOp::put(addr, entry);
   }
@@ -161,6 +337,279 @@ struct SharedMutexMap : public BaseOp {
   }
 };
 
+/**
+ * Direct-mapped base address lookup: Granules completely covered by a (large) allocation point to that allocation in a
+ * shadow table. The underlying map still holds every allocation and serves as overflow for all other addresses,
+ * e.g., small stack objects, or granules shared by several allocations.
+ * Invariant: A granule is only assigned to an allocation, if it lies within the allocation extent and before the next
+ * greater key in the map. Hence, the assigned allocation is always the one BaseOp::find would return.
+ */
+template <typename BaseOp>
+struct ShadowMap : public BaseOp {
+ private:
+  using Table = ShadowTable<>;
+  Table table_;
+  const TypeRegistry* types_;
+
+  inline void truncate_preceding(MemAddr addr) {
+    // A new key inside the granules of a preceding allocation splits its assigned range.
+    const auto granule = Table::granule_of(addr);
+    for (const auto candidate : {granule, granule + 1}) {
+      const auto* slot = table_.lookup_granule(candidate);
+      if (slot != nullptr && slot->base < addr) {
+        table_.clear_from(candidate, slot->base);
+        return;
+      }
+    }
+  }
+
+ public:
+  explicit ShadowMap(const TypeRegistry& types) : types_(&types) {
+  }
+
+  [[nodiscard]] inline llvm::Optional<RuntimeT::MapEntry> find(MemAddr addr) const {
+    if (const auto* slot = table_.lookup(addr); slot != nullptr) {
+      return RuntimeT::MapEntry{slot->base, slot->info};
+    }
+    return BaseOp::find(addr);
+  }
+
+  [[nodiscard]] inline PutResult put(MemAddr addr, const RuntimeT::MappedType& entry) {
+    auto result = BaseOp::put(addr, entry);
+    if (result.overridden) {
+      table_.clear_from(Table::first_granule_of(addr), addr);
+    }
+    truncate_preceding(addr);
+
+    const auto begin  = reinterpret_cast<uintptr_t>(addr);
+    const size_t size = types_->db().getTypeSize(entry.typeId) * entry.count;
+    if (size < Table::GranuleSize) {
+      return result;
+    }
+
+    uintptr_t end    = begin + size;
+    const auto& map  = this->map();
+    const auto after = map.upper_bound(addr);
+    if (after != map.end()) {
+      end = std::min(end, reinterpret_cast<uintptr_t>(after->first));
+    }
+    table_.assign(Table::first_granule_of(addr), Table::granule_of(reinterpret_cast<MemAddr>(end)), addr, entry);
+    return result;
+  }
+
+  [[nodiscard]] inline llvm::Optional<RuntimeT::MappedType> remove(MemAddr addr) {
+    auto removed = BaseOp::remove(addr);
+    if (removed) {
+      table_.clear_from(Table::first_granule_of(addr), addr);
+    }
+    return removed;
+  }
+
+  template <typename FwdIter, typename Callback>
+  inline void remove_range(FwdIter&& s, FwdIter&& e, Callback&& log) {
+    BaseOp::remove_range(std::forward<FwdIter>(s), std::forward<FwdIter>(e),
+                         [&](llvm::Optional<RuntimeT::MappedType>& removed, MemAddr addr) {
+                           if (removed) {
+                             table_.clear_from(Table::first_granule_of(addr), addr);
+                           }
+                           log(removed, addr);
+                         });
+  }
+};
+
+/**
+ * Splits the address space into regions of 2^RegionBits bytes, each region is assigned (round-robin) to one of
+ * 2^ShardBits independently locked maps.
+ * Threads operating on distinct memory regions (e.g., their own malloc arena) thus rarely contend for the same lock.
+ */
+template <typename BaseOp, unsigned ShardBits = 4, unsigned RegionBits = 12>
+struct ShardedMap {
+  static constexpr size_t NumShards{size_t{1} << ShardBits};
+
+ private:
+  struct alignas(64) Shard final : public SharedMutexMap<StandardMapBase<BaseOp>> {};
+  std::array<Shard, NumShards> shards_;
+
+  [[nodiscard]] inline static uintptr_t region_of(MemAddr addr) {
+    return reinterpret_cast<uintptr_t>(addr) >> RegionBits;
+  }
+
+  [[nodiscard]] inline const Shard& shard_at(uintptr_t region) const {
+    return shards_[region & (NumShards - 1)];
+  }
+
+  [[nodiscard]] inline Shard& shard_at(uintptr_t region) {
+    return shards_[region & (NumShards - 1)];
+  }
+
+ public:
+  [[nodiscard]] inline llvm::Optional<RuntimeT::MapEntry> find(MemAddr addr) const {
+    const auto region = region_of(addr);
+    auto result       = shard_at(region).find(addr);
+
+    // The base address may lie in a preceding region, i.e., it is stored in a neighbouring shard.
+    // Walk backwards, a shard can only hold a closer base address than the current result, if the result is stored
+    // in a region before the (most recent) region of that shard.
+    for (uintptr_t distance = 1; distance < NumShards; ++distance) {
+      if (result && region_of(result->first) + distance > region) {
+        break;
+      }
+      auto candidate = shard_at(region - distance).find(addr);
+      if (candidate && (!result || candidate->first > result->first)) {
+        result.emplace(*candidate);
+      }
+    }
+
+    return result;
+  }
+
+  template <typename FwdIter, typename Callback>
+  inline void find_range(FwdIter&& s, FwdIter&& e, Callback&& found) const {
+    std::for_each(s, e, [&](MemAddr addr) {
+      auto base = find(addr);
+      found(base, addr);
+    });
+  }
+
+  [[nodiscard]] inline PutResult put(MemAddr addr, const RuntimeT::MappedType& entry) {
+    return shard_at(region_of(addr)).put(addr, entry);
+  }
+
+  /**
+   * As put, the previous entry is the closest preceding entry of all shards.
+   */
+  [[nodiscard]] inline PutResult put_with_previous(MemAddr addr, const RuntimeT::MappedType& entry) {
+    auto result = put(addr, entry);
+    if (!result.previous || region_of(result.previous->first) != region_of(addr)) {
+      // A closer preceding entry may be stored in the shard of a preceding region:
+      auto previous = find(static_cast<const char*>(addr) - 1);
+      if (previous && (!result.previous || previous->first > result.previous->first)) {
+        result.previous.emplace(*previous);
+      }
+    }
+    return result;
+  }
+
+  [[nodiscard]] inline llvm::Optional<RuntimeT::MappedType> remove(MemAddr addr) {
+    return shard_at(region_of(addr)).remove(addr);
+  }
+
+  template <typename FwdIter, typename Callback>
+  inline void remove_range(FwdIter&& s, FwdIter&& e, Callback&& log) {
+    std::for_each(s, e, [&](MemAddr addr) {
+      auto removed = remove(addr);
+      log(removed, addr);
+    });
+  }
+};
+
+namespace detail {
+template <typename Map, typename = void>
+struct has_put_with_previous : std::false_type {};
+
+template <typename Map>
+struct has_put_with_previous<Map, std::void_t<decltype(std::declval<Map&>().put_with_previous(
+                                      std::declval<MemAddr>(), std::declval<const RuntimeT::MappedType&>()))>>
+    : std::true_type {};
+}  // namespace detail
+
+/**
+ * Inserts an entry, the previous entry of the result is the closest preceding entry of the whole map. Only needed for
+ * nested allocations, a plain put of a sharded map does not look into other shards.
+ */
+template <typename Map>
+[[nodiscard]] inline PutResult put_with_previous(Map& map, MemAddr addr, const RuntimeT::MappedType& entry) {
+  if constexpr (detail::has_put_with_previous<Map>::value) {
+    return map.put_with_previous(addr, entry);
+  } else {
+    return map.put(addr, entry);
+  }
+}
+
+/**
+ * Left-right concurrency control: Two instances of the map are kept, readers never take a lock and access the
+ * instance published for reading. A (serialized) writer modifies the other instance, publishes it, and then waits for
+ * the readers of the previous epoch to depart before it applies the same modification to the now unused instance.
+ * Memory is never reclaimed while readers are active, as each instance is only modified after its epoch has drained.
+ */
+template <typename BaseOp>
+struct LeftRightMap {
+ private:
+  std::array<StandardMapBase<BaseOp>, 2> instances_;
+  std::atomic<unsigned> read_instance_{0};
+  std::atomic<unsigned> epoch_{0};
+  mutable std::array<detail::ReadIndicator, 2> readers_;
+  std::mutex writer_m;
+
+  template <typename Operation>
+  inline auto read(Operation&& operation) const {
+    auto& epoch_readers = readers_[epoch_.load(std::memory_order_seq_cst) & 1U];
+    epoch_readers.arrive();
+    auto result = operation(instances_[read_instance_.load(std::memory_order_seq_cst)]);
+    epoch_readers.depart();
+    return result;
+  }
+
+  inline void wait_for_readers() {
+    const unsigned previous_epoch = epoch_.load(std::memory_order_relaxed) & 1U;
+    const unsigned next_epoch     = previous_epoch ^ 1U;
+    while (!readers_[next_epoch].empty()) {
+      std::this_thread::yield();
+    }
+    epoch_.store(next_epoch, std::memory_order_seq_cst);
+    while (!readers_[previous_epoch].empty()) {
+      std::this_thread::yield();
+    }
+  }
+
+  template <typename Operation, typename Replay>
+  inline auto write(Operation&& operation, Replay&& replay) {
+    std::lock_guard<std::mutex> guard(writer_m);
+    const unsigned current = read_instance_.load(std::memory_order_relaxed);
+    auto result            = operation(instances_[current ^ 1U]);
+    read_instance_.store(current ^ 1U, std::memory_order_seq_cst);
+    wait_for_readers();
+    replay(instances_[current]);
+    return result;
+  }
+
+ public:
+  [[nodiscard]] inline llvm::Optional<RuntimeT::MapEntry> find(MemAddr addr) const {
+    return read([addr](const auto& instance) { return instance.find(addr); });
+  }
+
+  template <typename FwdIter, typename Callback>
+  inline void find_range(FwdIter&& s, FwdIter&& e, Callback&& found) const {
+    read([&](const auto& instance) {
+      instance.find_range(s, e, found);
+      return true;
+    });
+  }
+
+  [[nodiscard]] inline PutResult put(MemAddr addr, const RuntimeT::MappedType& entry) {
+    const auto operation = [addr, &entry](auto& instance) { return instance.put(addr, entry); };
+    return write(operation, operation);
+  }
+
+  [[nodiscard]] inline llvm::Optional<RuntimeT::MappedType> remove(MemAddr addr) {
+    const auto operation = [addr](auto& instance) { return instance.remove(addr); };
+    return write(operation, operation);
+  }
+
+  template <typename FwdIter, typename Callback>
+  inline void remove_range(FwdIter&& s, FwdIter&& e, Callback&& log) {
+    write(
+        [&](auto& instance) {
+          instance.remove_range(s, e, log);
+          return true;
+        },
+        [&](auto& instance) {
+          instance.remove_range(s, e, [](auto&&, auto&&) {});
+          return true;
+        });
+  }
+};
+
 #ifdef USE_SAFEPTR
 template <typename BaseOp>
 struct SafePtrdMap : protected BaseOp {
@@ -169,7 +618,14 @@ struct SafePtrdMap : protected BaseOp {
     return BaseOp::find(slockedAllocs, addr);
   }
 
-  [[nodiscard]] inline bool put(MemAddr addr, const RuntimeT::MappedType& entry) {
+  template <typename FwdIter, typename Callback>
+  inline void find_range(FwdIter&& s, FwdIter&& e, Callback&& found) const {
+    auto slockedAllocs = sf::slock_safe_ptr(this->map());
+    BaseOp::find_sorted(slockedAllocs, std::forward<FwdIter>(s), std::forward<FwdIter>(e),
+                        std::forward<Callback>(found));
+  }
+
+  [[nodiscard]] inline PutResult put(MemAddr addr, const RuntimeT::MappedType& entry) {
     auto guard = sf::xlock_safe_ptr(this->map());
     return BaseOp::put(guard, addr, entry);
   }
@@ -188,13 +644,225 @@ struct SafePtrdMap : protected BaseOp {
   }
 };
 #endif
+
+#ifdef TYPEART_MAP_BACKEND_SELECTION
+/**
+ * Type-erased pointer map, the backend is selected at startup with the environment variable
+ * TYPEART_MAP_BACKEND=<strategy>[:<container>], e.g., "sharded:std".
+ * Strategies: mutex, sharded, left-right, shadow, unsafe, unsafe-shadow. Containers: std (std::map), btree (only if
+ * built with Abseil or phmap). The default is the backend the runtime was configured with.
+ */
+class DynamicMap final {
+ public:
+  using RemoveCallback = llvm::function_ref<void(llvm::Optional<RuntimeT::MappedType>&, MemAddr)>;
+  using FindCallback   = llvm::function_ref<void(llvm::Optional<RuntimeT::MapEntry>&, MemAddr)>;
+
+ private:
+  struct Backend {
+    virtual ~Backend() = default;
+
+    [[nodiscard]] virtual llvm::Optional<RuntimeT::MapEntry> find(MemAddr addr) const = 0;
+
+    virtual void find_range(const MemAddr* s, const MemAddr* e, FindCallback found) const = 0;
+
+    [[nodiscard]] virtual PutResult put(MemAddr addr, const RuntimeT::MappedType& entry) = 0;
+
+    [[nodiscard]] virtual PutResult put_with_previous(MemAddr addr, const RuntimeT::MappedType& entry) = 0;
+
+    [[nodiscard]] virtual llvm::Optional<RuntimeT::MappedType> remove(MemAddr addr) = 0;
+
+    virtual void remove_range(const MemAddr* s, const MemAddr* e, RemoveCallback log) = 0;
+  };
+
+  template <typename Map>
+  struct BackendModel final : public Backend {
+    Map map;
+
+    explicit BackendModel(const TypeRegistry& types) : map(make_pointer_map<Map>(types)) {
+    }
+
+    [[nodiscard]] llvm::Optional<RuntimeT::MapEntry> find(MemAddr addr) const override {
+      return map.find(addr);
+    }
+
+    void find_range(const MemAddr* s, const MemAddr* e, FindCallback found) const override {
+      map.find_range(s, e, found);
+    }
+
+    [[nodiscard]] PutResult put(MemAddr addr, const RuntimeT::MappedType& entry) override {
+      return map.put(addr, entry);
+    }
+
+    [[nodiscard]] PutResult put_with_previous(MemAddr addr, const RuntimeT::MappedType& entry) override {
+      return mixin::put_with_previous(map, addr, entry);
+    }
+
+    [[nodiscard]] llvm::Optional<RuntimeT::MappedType> remove(MemAddr addr) override {
+      return map.remove(addr);
+    }
+
+    void remove_range(const MemAddr* s, const MemAddr* e, RemoveCallback log) override {
+      map.remove_range(s, e, log);
+    }
+  };
+
+  template <typename Container>
+  [[nodiscard]] static std::unique_ptr<Backend> make_backend(std::string_view strategy, const TypeRegistry& types) {
+    using Op = BasicMapOp<Container>;
+    if (strategy == "mutex") {
+      return std::make_unique<BackendModel<SharedMutexMap<StandardMapBase<Op>>>>(types);
+    }
+    if (strategy == "sharded") {
+      return std::make_unique<BackendModel<ShardedMap<Op>>>(types);
+    }
+    if (strategy == "left-right") {
+      return std::make_unique<BackendModel<LeftRightMap<Op>>>(types);
+    }
+    if (strategy == "shadow") {
+      return std::make_unique<BackendModel<SharedMutexMap<ShadowMap<StandardMapBase<Op>>>>>(types);
+    }
+    if (strategy == "unsafe") {
+      return std::make_unique<BackendModel<StandardMapBase<Op>>>(types);
+    }
+    if (strategy == "unsafe-shadow") {
+      return std::make_unique<BackendModel<ShadowMap<StandardMapBase<Op>>>>(types);
+    }
+    return nullptr;
+  }
+
+  [[nodiscard]] static std::unique_ptr<Backend> make_backend(std::string_view strategy, std::string_view container,
+                                                             const TypeRegistry& types) {
+    if (container == "std") {
+      return make_backend<std::map<MemAddr, PointerInfo>>(strategy, types);
+    }
+#if defined(TYPEART_ABSEIL) || defined(TYPEART_PHMAP)
+    if (container == "btree") {
+      return make_backend<RuntimeT::PointerMapBaseT>(strategy, types);
+    }
+#endif
+    if (container.empty()) {
+      return make_backend<RuntimeT::PointerMapBaseT>(strategy, types);
+    }
+    return nullptr;
+  }
+
+  [[nodiscard]] static std::pair<std::string_view, std::string_view> split(std::string_view backend) {
+    const auto separator = backend.find(':');
+    const auto strategy  = backend.substr(0, separator);
+    const auto container = separator == std::string_view::npos ? std::string_view{} : backend.substr(separator + 1);
+    return {strategy, container};
+  }
+
+  std::unique_ptr<Backend> backend_;
+  std::string name_;
+
+ public:
+  static constexpr std::array<std::string_view, 6> strategies{"mutex",  "sharded", "left-right",
+                                                              "shadow", "unsafe",  "unsafe-shadow"};
+
+#if defined(TYPEART_DISABLE_THREAD_SAFETY) && defined(TYPEART_SHADOW_MAP)
+  static constexpr std::string_view default_backend{"unsafe-shadow"};
+#elif defined(TYPEART_DISABLE_THREAD_SAFETY)
+  static constexpr std::string_view default_backend{"unsafe"};
+#elif defined(TYPEART_SHADOW_MAP)
+  static constexpr std::string_view default_backend{"shadow"};
+#elif defined(TYPEART_SHARDED_MAP)
+  static constexpr std::string_view default_backend{"sharded"};
+#elif defined(TYPEART_LEFT_RIGHT_MAP)
+  static constexpr std::string_view default_backend{"left-right"};
+#else
+  static constexpr std::string_view default_backend{"mutex"};
+#endif
+
+  explicit DynamicMap(const TypeRegistry& types) {
+    const char* selection = std::getenv("TYPEART_MAP_BACKEND");
+    if (selection != nullptr && *selection != '\0') {
+      const std::string_view backend{selection};
+      const auto [strategy, container] = split(backend);
+      backend_                         = make_backend(strategy, container, types);
+      if (backend_) {
+        name_ = std::string{backend};
+      } else {
+        LOG_WARNING("Unknown map backend TYPEART_MAP_BACKEND=" << selection << ". Using default "
+                                                               << default_backend.data());
+      }
+    }
+    if (!backend_) {
+      backend_ = make_backend(default_backend, {}, types);
+      name_    = std::string{default_backend};
+    }
+    LOG_INFO("Pointer map backend: " << name_);
+  }
+
+  [[nodiscard]] const std::string& name() const {
+    return name_;
+  }
+
+  /**
+   * True, if backend (<strategy>[:<container>]) is available in this build, i.e., selecting it does not fall back to
+   * the default.
+   */
+  [[nodiscard]] static bool is_valid(std::string_view backend) {
+    const auto [strategy, container] = split(backend);
+    if (std::find(strategies.begin(), strategies.end(), strategy) == strategies.end()) {
+      return false;
+    }
+#if defined(TYPEART_ABSEIL) || defined(TYPEART_PHMAP)
+    if (container == "btree") {
+      return true;
+    }
+#endif
+    return container.empty() || container == "std";
+  }
+
+  [[nodiscard]] inline llvm::Optional<RuntimeT::MapEntry> find(MemAddr addr) const {
+    return backend_->find(addr);
+  }
+
+  template <typename FwdIter, typename Callback>
+  inline void find_range(FwdIter&& s, FwdIter&& e, Callback&& found) const {
+    const llvm::SmallVector<MemAddr, 16> addresses(s, e);
+    backend_->find_range(addresses.begin(), addresses.end(), found);
+  }
+
+  [[nodiscard]] inline PutResult put(MemAddr addr, const RuntimeT::MappedType& entry) {
+    return backend_->put(addr, entry);
+  }
+
+  [[nodiscard]] inline PutResult put_with_previous(MemAddr addr, const RuntimeT::MappedType& entry) {
+    return backend_->put_with_previous(addr, entry);
+  }
+
+  [[nodiscard]] inline llvm::Optional<RuntimeT::MappedType> remove(MemAddr addr) {
+    return backend_->remove(addr);
+  }
+
+  template <typename FwdIter, typename Callback>
+  inline void remove_range(FwdIter&& s, FwdIter&& e, Callback&& log) {
+    const llvm::SmallVector<MemAddr, 16> addresses(s, e);
+    backend_->remove_range(addresses.begin(), addresses.end(), log);
+  }
+};
+#endif
 }  // namespace mixin
 
 #ifdef USE_SAFEPTR
 using PointerMap = mixin::SafePtrdMap<mixin::MapOp>;
 #else
-#ifdef TYPEART_DISABLE_THREAD_SAFETY
+#ifdef TYPEART_MAP_BACKEND_SELECTION
+using PointerMap = mixin::DynamicMap;
+#elif defined(TYPEART_DISABLE_THREAD_SAFETY)
+#ifdef TYPEART_SHADOW_MAP
+using PointerMap = mixin::ShadowMap<mixin::StandardMapBase<mixin::MapOp>>;
+#else
 using PointerMap = mixin::StandardMapBase<mixin::MapOp>;
+#endif
+#elif defined(TYPEART_SHADOW_MAP)
+using PointerMap = mixin::SharedMutexMap<mixin::ShadowMap<mixin::StandardMapBase<mixin::MapOp>>>;
+#elif defined(TYPEART_SHARDED_MAP)
+using PointerMap = mixin::ShardedMap<mixin::MapOp>;
+#elif defined(TYPEART_LEFT_RIGHT_MAP)
+using PointerMap = mixin::LeftRightMap<mixin::MapOp>;
 #else
 using PointerMap = mixin::SharedMutexMap<mixin::StandardMapBase<mixin::MapOp>>;
 #endif
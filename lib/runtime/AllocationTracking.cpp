@@ -13,10 +13,12 @@
 #include "AllocationTracking.h"
 
 #include "AccessCounter.h"
+#include "CallSiteTable.h"
 #include "CallbackInterface.h"
 #include "Runtime.h"
 #include "RuntimeData.h"
-#include "TypeDB.h"
+#include "StackTracking.h"
+#include "TypeRegistry.h"
 #include "support/Logger.h"
 
 #include "llvm/ADT/Optional.h"
@@ -25,6 +27,7 @@
 #include <algorithm>
 #include <cassert>
 #include <iterator>
+#include <memory>
 #include <type_traits>
 #include <vector>
 
@@ -93,11 +96,24 @@ inline typename std::underlying_type<Enum>::type operator==(Enum lhs, Enum rhs)
 using namespace debug;
 
 namespace {
+StackRegistry& stack_registry() {
+  static StackRegistry registry;
+  return registry;
+}
+
 struct ThreadData final {
-  RuntimeT::Stack stackVars;
+  ThreadStack stack;
+  ThreadLookupCache cache;
+#ifdef TYPEART_DEFERRED_FREE
+  std::shared_ptr<FreeQueue> freeQueue;
+#endif
 
   ThreadData() {
-    stackVars.reserve(RuntimeT::StackReserve);
+    stack_registry().add(&stack);
+  }
+
+  ~ThreadData() {
+    stack_registry().erase(&stack);
   }
 };
 
@@ -105,7 +121,13 @@ thread_local ThreadData threadData;
 
 }  // namespace
 
-AllocationTracker::AllocationTracker(const TypeDB& db, Recorder& recorder) : typeDB{db}, recorder{recorder} {
+AllocationTracker::AllocationTracker(const TypeRegistry& type_registry, LazyTypeLoader& type_loader, Recorder& recorder,
+                                     EventTracer& event_tracer)
+    : wrapper{make_pointer_map<PointerMap>(type_registry)},
+      types{type_registry},
+      typeLoader{type_loader},
+      recorder{recorder},
+      tracer{event_tracer} {
 }
 
 void AllocationTracker::onAlloc(const void* addr, int typeId, size_t count, const void* retAddr) {
@@ -113,29 +135,62 @@ void AllocationTracker::onAlloc(const void* addr, int typeId, size_t count, cons
   if (status != AllocState::ADDR_SKIPPED) {
     recorder.incHeapAlloc(typeId, count);
   }
+  tracer.record(trace::EventKind::alloc_heap, addr, typeId, count, retAddr, static_cast<unsigned>(status));
   LOG_TRACE("Alloc " << toString(addr, typeId, count, retAddr) << " " << 'H');
 }
 
 void AllocationTracker::onAllocStack(const void* addr, int typeId, size_t count, const void* retAddr) {
-  const auto status = doAlloc(addr, typeId, count, retAddr);
+  const auto status = doAlloc(addr, typeId, count, retAddr, [&](const PointerInfo& info) {
+    const bool overridden = threadData.stack.put(addr, info, types.db().getTypeSize(typeId) * count);
+    return overridden || globals.contains_base(addr);
+  });
   if (status != AllocState::ADDR_SKIPPED) {
-    threadData.stackVars.push_back(addr);
     recorder.incStackAlloc(typeId, count);
   }
+  tracer.record(trace::EventKind::alloc_stack, addr, typeId, count, retAddr, static_cast<unsigned>(status));
   LOG_TRACE("Alloc " << toString(addr, typeId, count, retAddr) << " " << 'S');
 }
 
 void AllocationTracker::onAllocGlobal(const void* addr, int typeId, size_t count, const void* retAddr) {
-  const auto status = doAlloc(addr, typeId, count, retAddr);
+  const auto status =
+      doAlloc(addr, typeId, count, retAddr, [&](const PointerInfo& info) { return globals.put(addr, info); });
   if (status != AllocState::ADDR_SKIPPED) {
     recorder.incGlobalAlloc(typeId, count);
   }
+  tracer.record(trace::EventKind::alloc_global, addr, typeId, count, retAddr, static_cast<unsigned>(status));
   LOG_TRACE("Alloc " << toString(addr, typeId, count, retAddr) << " " << 'G');
 }
 
 AllocState AllocationTracker::doAlloc(const void* addr, int typeId, size_t count, const void* retAddr) {
+  return doAlloc(addr, typeId, count, retAddr, [&](const PointerInfo& info) {
+#ifdef TYPEART_DEFERRED_FREE
+    // The address may have been freed (deferred) and returned again by the allocator:
+    if (deferredFrees.maybe_pending(addr)) {
+      drainFrees();
+    }
+#endif
+    bool overridden{false};
+    if constexpr (ThreadLookupCache::enabled) {
+      // Nested allocations are only tracked for the cache:
+      const auto result = mixin::put_with_previous(wrapper, addr, info);
+      if (unlikely(result.previous && contains(*result.previous, addr))) {
+        checkNested(addr, *result.previous);
+      }
+      overridden = result.overridden;
+    } else {
+      overridden = wrapper.put(addr, info).overridden;
+    }
+    // Globals are kept in a separate table, an allocation at the base of a global is an address reuse as well:
+    return overridden || globals.contains_base(addr);
+  });
+}
+
+template <typename PutFn>
+AllocState AllocationTracker::doAlloc(const void* addr, int typeId, size_t count, const void* retAddr, PutFn&& put) {
   AllocState status = AllocState::NO_INIT;
-  if (unlikely(!typeDB.isValid(typeId))) {
+  // Allocations of built-in types do not wait for the type file:
+  typeLoader.require(typeId);
+  if (unlikely(!types.db().isValid(typeId))) {
     status |= AllocState::UNKNOWN_ID;
     LOG_ERROR("Allocation of unknown type " << toString(addr, typeId, count, retAddr));
   }
@@ -158,9 +213,10 @@ AllocState AllocationTracker::doAlloc(const void* addr, int typeId, size_t count
     return status | AllocState::NULL_PTR | AllocState::ADDR_SKIPPED;
   }
 
-  const auto overridden = wrapper.put(addr, PointerInfo{typeId, count, retAddr});
+  const auto overridden = put(make_pointer_info(typeId, count, retAddr));
 
   if (unlikely(overridden)) {
+    invalidateLookups();
     recorder.incAddrReuse();
     status |= AllocState::ADDR_REUSE;
     LOG_WARNING("Pointer already in map " << toString(addr, typeId, count, retAddr));
@@ -174,16 +230,30 @@ FreeState AllocationTracker::doFreeHeap(const void* addr, const void* retAddr) {
   if (unlikely(addr == nullptr)) {
     LOG_ERROR("Free on nullptr "
               << "(" << retAddr << ")");
-    return FreeState::ADDR_SKIPPED | FreeState::NULL_PTR;
+    const auto status = FreeState::ADDR_SKIPPED | FreeState::NULL_PTR;
+    tracer.record(trace::EventKind::free_heap, addr, TYPEART_UNKNOWN_TYPE, 0, retAddr, static_cast<unsigned>(status));
+    return status;
   }
 
-  llvm::Optional<PointerInfo> removed = wrapper.remove(addr);
+  const llvm::Optional<PointerInfo> removed = wrapper.remove(addr);
+  return finishFreeHeap(addr, retAddr, removed);
+}
 
+FreeState AllocationTracker::finishFreeHeap(const void* addr, const void* retAddr,
+                                            const llvm::Optional<PointerInfo>& removed) {
   if (unlikely(!removed)) {
     LOG_ERROR("Free on unregistered address " << addr << " (" << retAddr << ")");
-    return FreeState::ADDR_SKIPPED | FreeState::UNREG_ADDR;
+    const auto status = FreeState::ADDR_SKIPPED | FreeState::UNREG_ADDR;
+    tracer.record(trace::EventKind::free_heap, addr, TYPEART_UNKNOWN_TYPE, 0, retAddr, static_cast<unsigned>(status));
+    return status;
   }
 
+  invalidateLookups();
+  nestedAllocs.erase(addr);
+
+  tracer.record(trace::EventKind::free_heap, addr, removed->typeId, removed->count, retAddr,
+                static_cast<unsigned>(FreeState::OK));
+
   LOG_TRACE("Free " << toString(addr, *removed));
   if constexpr (!std::is_same_v<Recorder, softcounter::NoneRecorder>) {
     recorder.incHeapFree(removed->typeId, removed->count);
@@ -191,7 +261,51 @@ FreeState AllocationTracker::doFreeHeap(const void* addr, const void* retAddr) {
   return FreeState::OK;
 }
 
+#ifdef TYPEART_DEFERRED_FREE
+void AllocationTracker::deferFreeHeap(const void* addr, const void* retAddr) {
+  auto& queue = threadData.freeQueue;
+  if (unlikely(!queue)) {
+    queue = deferredFrees.make_queue();
+  }
+  const bool batch_full = deferredFrees.push(*queue, PendingFree{addr, retAddr});
+  // Cached lookups must not return the freed allocation before the free is applied:
+  invalidateLookups();
+  if (batch_full) {
+    drainFrees();
+  }
+}
+#endif
+
+void AllocationTracker::drainFrees() {
+#ifdef TYPEART_DEFERRED_FREE
+  deferredFrees.drain([&](const std::vector<PendingFree>& batch) {
+    llvm::SmallVector<MemAddr, DeferredFrees::BatchSize> addresses;
+    addresses.reserve(batch.size());
+    std::transform(batch.begin(), batch.end(), std::back_inserter(addresses),
+                   [](const PendingFree& item) { return item.addr; });
+
+    size_t index{0};
+    wrapper.remove_range(addresses.begin(), addresses.end(),
+                         [&](llvm::Optional<PointerInfo>& removed, MemAddr addr) {
+                           if (FreeState::OK == finishFreeHeap(addr, batch[index++].retAddr, removed)) {
+                             recorder.decHeapAlloc();
+                           }
+                         });
+  });
+#endif
+}
+
+void AllocationTracker::flush() {
+  drainFrees();
+}
+
 void AllocationTracker::onFreeHeap(const void* addr, const void* retAddr) {
+#ifdef TYPEART_DEFERRED_FREE
+  if (likely(addr != nullptr)) {
+    deferFreeHeap(addr, retAddr);
+    return;
+  }
+#endif
   const auto status = doFreeHeap(addr, retAddr);
   if (FreeState::OK == status) {
     recorder.decHeapAlloc();
@@ -199,20 +313,25 @@ void AllocationTracker::onFreeHeap(const void* addr, const void* retAddr) {
 }
 
 void AllocationTracker::onLeaveScope(int alloca_count, const void* retAddr) {
-  if (unlikely(alloca_count > static_cast<int>(threadData.stackVars.size()))) {
-    LOG_ERROR("Stack is smaller than requested de-allocation count. alloca_count: " << alloca_count << ". size: "
-                                                                                    << threadData.stackVars.size());
-    alloca_count = threadData.stackVars.size();
+  auto& stack = threadData.stack;
+  if (unlikely(alloca_count > static_cast<int>(stack.size()))) {
+    LOG_ERROR("Stack is smaller than requested de-allocation count. alloca_count: " << alloca_count
+                                                                                    << ". size: " << stack.size());
+    alloca_count = stack.size();
   }
 
-  const auto cend      = threadData.stackVars.cend();
-  const auto start_pos = (cend - alloca_count);
-  LOG_TRACE("Freeing stack (" << alloca_count << ")  " << std::distance(start_pos, threadData.stackVars.cend()))
+  tracer.record(trace::EventKind::leave_scope, nullptr, TYPEART_UNKNOWN_TYPE, alloca_count, retAddr, 0);
+  LOG_TRACE("Freeing stack (" << alloca_count << ")")
 
-  wrapper.remove_range(start_pos, cend, [&](llvm::Optional<PointerInfo>& removed, MemAddr addr) {
+  auto& cache = threadData.cache;
+  stack.pop(alloca_count, [&](llvm::Optional<PointerInfo>& removed, MemAddr addr) {
+    // Stack entries are only ever cached by their owning thread (see findBaseAlloc):
+    cache.erase(addr);
     if (unlikely(!removed)) {
       LOG_ERROR("Free on unregistered address " << addr << " (" << retAddr << ")");
     } else {
+      tracer.record(trace::EventKind::free_stack, addr, removed->typeId, removed->count, retAddr,
+                    static_cast<unsigned>(FreeState::OK));
       LOG_TRACE("Free " << toString(addr, *removed));
       if constexpr (!std::is_same_v<Recorder, softcounter::NoneRecorder>) {
         recorder.incStackFree(removed->typeId, removed->count);
@@ -220,13 +339,135 @@ void AllocationTracker::onLeaveScope(int alloca_count, const void* retAddr) {
     }
   });
 
-  threadData.stackVars.erase(start_pos, cend);
   recorder.decStackAlloc(alloca_count);
-  LOG_TRACE("Stack after free: " << threadData.stackVars.size());
+  LOG_TRACE("Stack after free: " << stack.size());
+}
+
+size_t AllocationTracker::extentOf(const PointerInfo& info) const {
+  return types.db().getTypeSize(info.typeId) * info.count;
+}
+
+bool AllocationTracker::contains(const RuntimeT::MapEntry& entry, const void* addr) const {
+  const auto* base      = static_cast<const char*>(entry.first);
+  const auto* candidate = static_cast<const char*>(addr);
+  return base <= candidate && candidate < base + extentOf(entry.second);
 }
+
+void AllocationTracker::checkNested(const void* addr, const RuntimeT::MapEntry& previous) {
+#ifdef TYPEART_DEFERRED_FREE
+  // The enclosing allocation may be freed already, i.e., the allocator reused its memory:
+  if (deferredFrees.maybe_pending(previous.first)) {
+    drainFrees();
+    const auto live = wrapper.find(previous.first);
+    if (!live || live->first != previous.first || !contains(*live, addr)) {
+      return;
+    }
+  }
+#endif
+  // Cached extents of the enclosing allocation cover the new one:
+  nestedAllocs.insert(addr);
+  invalidateLookups();
+}
+
+bool AllocationTracker::containsNested(const RuntimeT::MapEntry& entry) const {
+  const auto* last = static_cast<const char*>(entry.first) + extentOf(entry.second) - 1;
+  const auto other = wrapper.find(last);
+  return other && other->first > entry.first;
+}
+
+void AllocationTracker::cacheLookup(const RuntimeT::MapEntry& resolved, uint64_t current_epoch) {
+  threadData.cache.insert(resolved, extentOf(resolved.second), current_epoch);
+}
+
+void AllocationTracker::invalidateLookups() {
+  if constexpr (ThreadLookupCache::enabled) {
+    epoch.bump();
+  }
+}
+
+llvm::Optional<RuntimeT::MapEntry> AllocationTracker::findHeapAlloc(const void* addr) {
+#ifdef TYPEART_DEFERRED_FREE
+  {
+    auto map_base = wrapper.find(addr);
+    if (!map_base || !deferredFrees.maybe_pending(map_base->first)) {
+      return map_base;
+    }
+  }
+  // Result may be outdated by a pending free:
+  drainFrees();
+#endif
+  return wrapper.find(addr);
+}
+
 // Base address
 llvm::Optional<RuntimeT::MapEntry> AllocationTracker::findBaseAlloc(const void* addr) {
-  return wrapper.find(addr);
+  return findBaseAlloc(addr, [&]() { return findHeapAlloc(addr); });
+}
+
+void AllocationTracker::findBaseAllocs(const void* const* addrs, size_t count,
+                                       llvm::Optional<RuntimeT::MapEntry>* bases) {
+  drainFrees();
+
+  // Heap lookups of the batch with a single map (lock) access:
+  const MemAddr* last = addrs + count;
+  size_t index{0};
+  wrapper.find_range(addrs, last, [&](llvm::Optional<RuntimeT::MapEntry>& map_base, MemAddr) {
+    bases[index].reset();
+    if (map_base) {
+      bases[index].emplace(*map_base);
+    }
+    ++index;
+  });
+
+  for (index = 0; index < count; ++index) {
+    auto base = findBaseAlloc(addrs[index], [&]() { return bases[index]; });
+    bases[index].reset();
+    if (base) {
+      bases[index].emplace(*base);
+    }
+  }
+}
+
+template <typename MapLookup>
+llvm::Optional<RuntimeT::MapEntry> AllocationTracker::findBaseAlloc(const void* addr, MapLookup&& find_heap) {
+  auto& cache = threadData.cache;
+  uint64_t current_epoch{0};
+  if constexpr (ThreadLookupCache::enabled) {
+    current_epoch = epoch.current();
+    auto cached   = cache.find(addr, current_epoch);
+    if (cached) {
+      recorder.incLookupCacheHit();
+      return cached;
+    }
+    recorder.incLookupCacheMiss();
+  }
+
+  // The closest preceding entry containing addr is the base allocation (an allocation nested in another one, e.g.,
+  // after a missed free, takes precedence within its range):
+  const auto& stack     = threadData.stack;
+  const auto stack_base = stack.find(addr);
+  if (stack_base && contains(*stack_base, addr)) {
+    cacheLookup(*stack_base, current_epoch);
+    return stack_base;
+  }
+  const llvm::Optional<RuntimeT::MapEntry> map_base = find_heap();
+  if (map_base && contains(*map_base, addr)) {
+    // Only heap allocations are tracked as nested, a cached extent must not cover another allocation:
+    if (likely(nestedAllocs.empty()) || !containsNested(*map_base)) {
+      cacheLookup(*map_base, current_epoch);
+    }
+    return map_base;
+  }
+  const auto global_base = globals.find(addr);
+  if (global_base && contains(*global_base, addr)) {
+    cacheLookup(*global_base, current_epoch);
+    return global_base;
+  }
+  // Either on the stack of another thread (not cached, its owner may pop it any time), or an out-of-bounds address
+  // (report the closest preceding allocation):
+  const auto foreign_base = stack_registry().find(addr, &stack);
+  return detail::closest_base(
+      detail::closest_base(detail::closest_base(stack_base, map_base), global_base), foreign_base);
 }
 
 }  // namespace typeart
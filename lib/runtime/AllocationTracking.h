@@ -15,6 +15,11 @@
 
 #include "AccessCounter.h"
 #include "AllocMapWrapper.h"
+#include "DeferredFree.h"
+#include "EventTrace.h"
+#include "GlobalTable.h"
+#include "LazyTypeLoader.h"
+#include "LookupCache.h"
 #include "RuntimeData.h"
 
 #include <cstddef>
@@ -26,7 +31,7 @@ class Optional;
 
 namespace typeart {
 
-class TypeDB;
+class TypeRegistry;
 
 enum class AllocState : unsigned {
   NO_INIT      = 1 << 0,
@@ -49,11 +54,20 @@ enum class FreeState : unsigned {
 
 class AllocationTracker {
   PointerMap wrapper;
-  const TypeDB& typeDB;
+  GlobalTable globals;
+#ifdef TYPEART_DEFERRED_FREE
+  DeferredFrees deferredFrees;
+#endif
+  ModificationEpoch epoch;
+  NestedAllocations nestedAllocs;
+  const TypeRegistry& types;
+  LazyTypeLoader& typeLoader;
   Recorder& recorder;
+  EventTracer& tracer;
 
  public:
-  AllocationTracker(const TypeDB& db, Recorder& recorder);
+  AllocationTracker(const TypeRegistry& type_registry, LazyTypeLoader& type_loader, Recorder& recorder,
+                    EventTracer& event_tracer);
 
   void onAlloc(const void* addr, int typeID, size_t count, const void* retAddr);
 
@@ -67,10 +81,53 @@ class AllocationTracker {
 
   llvm::Optional<RuntimeT::MapEntry> findBaseAlloc(const void* addr);
 
+  /**
+   * Resolves the base allocations of count addresses, bases[i] corresponds to addrs[i].
+   * Heap allocations are looked up with one (sorted) sweep of the map.
+   */
+  void findBaseAllocs(const void* const* addrs, size_t count, llvm::Optional<RuntimeT::MapEntry>* bases);
+
+  /**
+   * Applies all pending (deferred) frees.
+   */
+  void flush();
+
  private:
   AllocState doAlloc(const void* addr, int typeID, size_t count, const void* retAddr);
 
+  template <typename PutFn>
+  AllocState doAlloc(const void* addr, int typeID, size_t count, const void* retAddr, PutFn&& put);
+
   FreeState doFreeHeap(const void* addr, const void* retAddr);
+
+  FreeState finishFreeHeap(const void* addr, const void* retAddr, const llvm::Optional<PointerInfo>& removed);
+
+#ifdef TYPEART_DEFERRED_FREE
+  void deferFreeHeap(const void* addr, const void* retAddr);
+#endif
+
+  void drainFrees();
+
+  llvm::Optional<RuntimeT::MapEntry> findHeapAlloc(const void* addr);
+
+  template <typename MapLookup>
+  llvm::Optional<RuntimeT::MapEntry> findBaseAlloc(const void* addr, MapLookup&& find_heap);
+
+  [[nodiscard]] size_t extentOf(const PointerInfo& info) const;
+
+  [[nodiscard]] bool contains(const RuntimeT::MapEntry& entry, const void* addr) const;
+
+  /**
+   * Records the heap allocation at addr as nested, if the preceding heap entry (returned by the map insertion)
+   * encloses it and is not freed (pending).
+   */
+  void checkNested(const void* addr, const RuntimeT::MapEntry& previous);
+
+  [[nodiscard]] bool containsNested(const RuntimeT::MapEntry& entry) const;
+
+  void cacheLookup(const RuntimeT::MapEntry& resolved, uint64_t current_epoch);
+
+  void invalidateLookups();
 };
 
 }  // namespace typeart
@@ -0,0 +1,112 @@
+// TypeART library
+//
+// Copyright (c) 2017-2022 TypeART Authors
+// Distributed under the BSD 3-Clause license.
+// (See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/BSD-3-Clause)
+//
+// Project home: https://github.com/tudasc/TypeART
+//
+// SPDX-License-Identifier: BSD-3-Clause
+//
+
+#ifndef TYPEART_CALLSITETABLE_H
+#define TYPEART_CALLSITETABLE_H
+
+#include "RuntimeData.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace typeart {
+
+/**
+ * Deduplicated table of allocation call sites (return addresses), used by the compact PointerInfo layout.
+ * Index 0 is reserved for unknown call sites.
+ */
+class CallSiteTable final {
+  std::vector<MemAddr> sites_{nullptr};
+  std::unordered_map<MemAddr, uint32_t> index_;
+  mutable std::shared_mutex table_m_;
+
+  CallSiteTable() = default;
+
+ public:
+  static constexpr uint32_t unknown_site{0};
+
+  static CallSiteTable& get() {
+    static CallSiteTable table;
+    return table;
+  }
+
+  CallSiteTable(const CallSiteTable&) = delete;
+
+  CallSiteTable& operator=(const CallSiteTable&) = delete;
+
+  [[nodiscard]] uint32_t intern(MemAddr site) {
+    // Allocations are typically issued repeatedly from the same call site:
+    thread_local std::pair<MemAddr, uint32_t> last_site{nullptr, unknown_site};
+    if (site == last_site.first) {
+      return last_site.second;
+    }
+
+    uint32_t index{unknown_site};
+    {
+      std::shared_lock<std::shared_mutex> guard(table_m_);
+      const auto it = index_.find(site);
+      if (it != index_.end()) {
+        index = it->second;
+      }
+    }
+    if (index == unknown_site && site != nullptr) {
+      std::lock_guard<std::shared_mutex> guard(table_m_);
+      const auto it = index_.find(site);
+      if (it != index_.end()) {
+        index = it->second;
+      } else if (sites_.size() < std::numeric_limits<uint32_t>::max()) {
+        index = static_cast<uint32_t>(sites_.size());
+        sites_.push_back(site);
+        index_.emplace(site, index);
+      }
+    }
+
+    last_site = {site, index};
+    return index;
+  }
+
+  [[nodiscard]] MemAddr lookup(uint32_t index) const {
+    std::shared_lock<std::shared_mutex> guard(table_m_);
+    return index < sites_.size() ? sites_[index] : nullptr;
+  }
+
+  [[nodiscard]] size_t size() const {
+    std::shared_lock<std::shared_mutex> guard(table_m_);
+    return sites_.size() - 1;
+  }
+};
+
+inline PointerInfo make_pointer_info(int type_id, size_t count, MemAddr return_address) {
+#ifdef TYPEART_COMPACT_POINTER_INFO
+  return PointerInfo{type_id, CallSiteTable::get().intern(return_address), count};
+#else
+  return PointerInfo{type_id, count, return_address};
+#endif
+}
+
+inline MemAddr return_address_of(const PointerInfo& info) {
+#ifdef TYPEART_COMPACT_POINTER_INFO
+  return CallSiteTable::get().lookup(info.site);
+#else
+  return info.debug;
+#endif
+}
+
+}  // namespace typeart
+
+#endif  // TYPEART_CALLSITETABLE_H
@@ -36,6 +36,9 @@ void __typeart_alloc_omp(const void* addr, int type_id, size_t count);
 void __typeart_free_omp(const void* addr);
 void __typeart_alloc_stack_omp(const void* addr, int type_id, size_t count);
 void __typeart_leave_scope_omp(int alloca_count);
+
+// Called from module constructors with the embedded type table of the module (pass flag -typeart-embed-types)
+void __typeart_register_types(const void* table, size_t size);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,128 @@
+// TypeART library
+//
+// Copyright (c) 2017-2022 TypeART Authors
+// Distributed under the BSD 3-Clause license.
+// (See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/BSD-3-Clause)
+//
+// Project home: https://github.com/tudasc/TypeART
+//
+// SPDX-License-Identifier: BSD-3-Clause
+//
+
+#ifndef TYPEART_DEFERREDFREE_H
+#define TYPEART_DEFERREDFREE_H
+
+#include "RuntimeData.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace typeart {
+
+struct PendingFree {
+  MemAddr addr{nullptr};
+  MemAddr retAddr{nullptr};
+};
+
+/**
+ * Frees of one thread, not yet applied to the pointer map.
+ * The mutex is only contended while another thread drains the queue.
+ */
+class FreeQueue final {
+  std::vector<PendingFree> items_;
+  std::mutex queue_m_;
+
+ public:
+  size_t push(const PendingFree& item) {
+    std::lock_guard<std::mutex> guard(queue_m_);
+    items_.push_back(item);
+    return items_.size();
+  }
+
+  void take(std::vector<PendingFree>& out) {
+    std::lock_guard<std::mutex> guard(queue_m_);
+    out.insert(out.end(), items_.begin(), items_.end());
+    items_.clear();
+  }
+};
+
+/**
+ * Registry of all per-thread free queues.
+ * A counting filter over the queued addresses lets allocations and queries check cheaply (and conservatively) whether
+ * an address may have a pending free. Counters are only decremented after the free was applied to the map, hence a
+ * zero counter guarantees that the map is exact for that address.
+ */
+class DeferredFrees final {
+  static constexpr unsigned FilterBits{12};
+
+  std::array<std::atomic<uint32_t>, size_t{1} << FilterBits> filter_{};
+  std::vector<std::shared_ptr<FreeQueue>> queues_;
+  std::mutex registry_m_;
+  std::mutex drain_m_;
+
+  [[nodiscard]] static size_t slot_of(MemAddr addr) {
+    const auto key = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(addr) >> 4);
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> (64 - FilterBits));
+  }
+
+ public:
+  static constexpr size_t BatchSize{64};
+
+  [[nodiscard]] std::shared_ptr<FreeQueue> make_queue() {
+    auto queue = std::make_shared<FreeQueue>();
+    std::lock_guard<std::mutex> guard(registry_m_);
+    queues_.push_back(queue);
+    return queue;
+  }
+
+  /**
+   * @return true, if the queue holds a full batch and should be drained.
+   */
+  [[nodiscard]] bool push(FreeQueue& queue, const PendingFree& item) {
+    const auto size = queue.push(item);
+    filter_[slot_of(item.addr)].fetch_add(1, std::memory_order_release);
+    return size >= BatchSize;
+  }
+
+  [[nodiscard]] bool maybe_pending(MemAddr addr) const {
+    return filter_[slot_of(addr)].load(std::memory_order_acquire) != 0;
+  }
+
+  /**
+   * Takes all pending frees of all threads and applies them with apply(const std::vector<PendingFree>&).
+   * Concurrent drains are serialized, a drain returns only after all frees pending at its start are applied.
+   */
+  template <typename ApplyFn>
+  void drain(ApplyFn&& apply) {
+    std::lock_guard<std::mutex> drain_guard(drain_m_);
+    std::vector<PendingFree> batch;
+    {
+      std::lock_guard<std::mutex> guard(registry_m_);
+      for (auto& queue : queues_) {
+        queue->take(batch);
+      }
+      // Queues of terminated threads are released once empty:
+      queues_.erase(std::remove_if(queues_.begin(), queues_.end(),
+                                   [](const auto& queue) { return queue.use_count() == 1; }),
+                    queues_.end());
+    }
+    if (batch.empty()) {
+      return;
+    }
+    apply(batch);
+    for (const auto& item : batch) {
+      filter_[slot_of(item.addr)].fetch_sub(1, std::memory_order_release);
+    }
+  }
+};
+
+}  // namespace typeart
+
+#endif  // TYPEART_DEFERREDFREE_H
@@ -0,0 +1,208 @@
+// TypeART library
+//
+// Copyright (c) 2017-2022 TypeART Authors
+// Distributed under the BSD 3-Clause license.
+// (See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/BSD-3-Clause)
+//
+// Project home: https://github.com/tudasc/TypeART
+//
+// SPDX-License-Identifier: BSD-3-Clause
+//
+
+#ifndef TYPEART_DISTINCTCOUNTER_H
+#define TYPEART_DISTINCTCOUNTER_H
+
+#include "RuntimeData.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_set>
+
+namespace typeart::softcounter {
+
+/**
+ * How distinct addresses are counted: exact (a set of all addresses) or estimated with a HyperLogLog sketch of
+ * 2^precision one-byte registers. Selected with the env variable TYPEART_DISTINCT_COUNT=exact|hll[:<precision>].
+ */
+struct DistinctConfig {
+  enum class Mode { exact, sketch };
+
+  static constexpr unsigned MinPrecision     = 4;
+  static constexpr unsigned MaxPrecision     = 18;
+  static constexpr unsigned DefaultPrecision = 12;
+
+  Mode mode{Mode::sketch};
+  unsigned precision{DefaultPrecision};
+
+  static DistinctConfig exact() {
+    return DistinctConfig{Mode::exact, DefaultPrecision};
+  }
+
+  static DistinctConfig sketch(unsigned precision = DefaultPrecision) {
+    if (precision < MinPrecision) {
+      precision = MinPrecision;
+    } else if (precision > MaxPrecision) {
+      precision = MaxPrecision;
+    }
+    return DistinctConfig{Mode::sketch, precision};
+  }
+
+  /**
+   * Parses TYPEART_DISTINCT_COUNT, an unset or unknown value selects the default sketch.
+   */
+  static DistinctConfig fromEnv() {
+    const char* selection = std::getenv("TYPEART_DISTINCT_COUNT");
+    if (selection == nullptr) {
+      return sketch();
+    }
+    const std::string_view value{selection};
+    if (value == "exact") {
+      return exact();
+    }
+    if (value.substr(0, 4) == "hll:") {
+      return sketch(static_cast<unsigned>(std::strtoul(selection + 4, nullptr, 10)));
+    }
+    return sketch();
+  }
+};
+
+/**
+ * Count of distinct values, the estimate has a relative error of error_bound (~95% confidence), exact counts have none.
+ */
+struct DistinctCount {
+  size_t count{0};
+  double error_bound{0.0};
+  bool exact{true};
+};
+
+namespace detail {
+/**
+ * HyperLogLog (Flajolet et al., 2007) with 64 bit hashes, hence no large range correction. Registers are updated with
+ * an atomic max, adding an already seen address only reads its register.
+ */
+class HyperLogLog {
+ public:
+  explicit HyperLogLog(unsigned precision_bits)
+      : precision(precision_bits), registers(std::make_unique<std::atomic<uint8_t>[]>(size_t{1} << precision_bits)) {
+    for (size_t index = 0; index < num_registers(); ++index) {
+      registers[index].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  inline void add(MemAddr addr) {
+    const uint64_t hash  = mix(reinterpret_cast<uintptr_t>(addr));
+    const size_t index   = hash >> (64 - precision);
+    const uint64_t rest  = (hash << precision) | (uint64_t{1} << (precision - 1));
+    const uint8_t rank   = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+    auto& reg            = registers[index];
+    uint8_t current_rank = reg.load(std::memory_order_relaxed);
+    while (current_rank < rank && !reg.compare_exchange_weak(current_rank, rank, std::memory_order_relaxed)) {
+    }
+  }
+
+  [[nodiscard]] size_t estimate() const {
+    const double m = static_cast<double>(num_registers());
+    double sum{0.0};
+    size_t zeros{0};
+    for (size_t index = 0; index < num_registers(); ++index) {
+      const auto rank = registers[index].load(std::memory_order_relaxed);
+      sum += std::ldexp(1.0, -rank);
+      zeros += rank == 0 ? 1 : 0;
+    }
+    const double raw = alpha() * m * m / sum;
+    if (raw <= 2.5 * m && zeros != 0) {
+      // Small range: linear counting
+      return static_cast<size_t>(std::llround(m * std::log(m / static_cast<double>(zeros))));
+    }
+    return static_cast<size_t>(std::llround(raw));
+  }
+
+  [[nodiscard]] double error_bound() const {
+    // Two standard errors (1.04 / sqrt(m))
+    return 2.0 * 1.04 / std::sqrt(static_cast<double>(num_registers()));
+  }
+
+ private:
+  [[nodiscard]] size_t num_registers() const {
+    return size_t{1} << precision;
+  }
+
+  [[nodiscard]] double alpha() const {
+    switch (precision) {
+      case 4:
+        return 0.673;
+      case 5:
+        return 0.697;
+      case 6:
+        return 0.709;
+      default:
+        return 0.7213 / (1.0 + 1.079 / static_cast<double>(num_registers()));
+    }
+  }
+
+  static inline uint64_t mix(uint64_t value) {
+    // splitmix64 finalizer, addresses are aligned and clustered
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+  }
+
+  const unsigned precision;
+  std::unique_ptr<std::atomic<uint8_t>[]> registers;
+};
+}  // namespace detail
+
+/**
+ * Counts distinct addresses, exactly (memory grows with each distinct address) or with a fixed-size sketch.
+ */
+class DistinctCounter {
+ public:
+  using AddressSet = std::unordered_set<MemAddr>;
+
+  explicit DistinctCounter(const DistinctConfig& config) {
+    if (config.mode == DistinctConfig::Mode::sketch) {
+      sketch = std::make_unique<detail::HyperLogLog>(config.precision);
+    }
+  }
+
+  inline void add(MemAddr addr) {
+    if (sketch) {
+      sketch->add(addr);
+      return;
+    }
+    std::lock_guard lock(mutex);
+    addresses.insert(addr);
+  }
+
+  [[nodiscard]] DistinctCount count() const {
+    if (sketch) {
+      return DistinctCount{sketch->estimate(), sketch->error_bound(), false};
+    }
+    std::shared_lock lock(mutex);
+    return DistinctCount{addresses.size(), 0.0, true};
+  }
+
+  /**
+   * @return the distinct addresses, empty if counted with a sketch.
+   */
+  [[nodiscard]] AddressSet values() const {
+    std::shared_lock lock(mutex);
+    return addresses;
+  }
+
+ private:
+  std::unique_ptr<detail::HyperLogLog> sketch;
+  AddressSet addresses;
+  mutable std::shared_mutex mutex;
+};
+
+}  // namespace typeart::softcounter
+
+#endif  // TYPEART_DISTINCTCOUNTER_H
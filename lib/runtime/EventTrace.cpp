@@ -0,0 +1,147 @@
+// TypeART library
+//
+// Copyright (c) 2017-2022 TypeART Authors
+// Distributed under the BSD 3-Clause license.
+// (See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/BSD-3-Clause)
+//
+// Project home: https://github.com/tudasc/TypeART
+//
+// SPDX-License-Identifier: BSD-3-Clause
+//
+
+#include "EventTrace.h"
+
+#include "support/Logger.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+namespace typeart::trace {
+
+namespace {
+constexpr auto FlushInterval = std::chrono::milliseconds{20};
+// Waiting for room to report the records a thread dropped before its exit:
+constexpr unsigned ExitWaitAttempts{50};
+
+std::string trace_file_name(std::string name) {
+  const auto position = name.find("%p");
+  if (position != std::string::npos) {
+    name.replace(position, 2, std::to_string(::getpid()));
+  }
+  return name;
+}
+
+uint64_t next_instance_id() {
+  static std::atomic<uint64_t> instances{0};
+  return ++instances;
+}
+}  // namespace
+
+RingTracer::RingTracer() : instanceId(next_instance_id()) {
+  const char* selection = std::getenv("TYPEART_TRACE_FILE");
+  if (selection == nullptr || *selection == '\0') {
+    return;
+  }
+  const auto name = trace_file_name(selection);
+  file            = std::fopen(name.c_str(), "wb");
+  if (file == nullptr) {
+    LOG_ERROR("Failed to open trace file " << name << ". Reason: " << std::strerror(errno));
+    return;
+  }
+  const FileHeader header{Magic, Version, ByteOrderMark, sizeof(Record), 0};
+  std::fwrite(&header, sizeof(header), 1, file);
+  writeClock();
+  LOG_INFO("Writing event trace to " << name);
+
+  flusher = std::thread([this] { flushLoop(); });
+}
+
+RingTracer::~RingTracer() {
+  if (file == nullptr) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(wakeMutex);
+    stop = true;
+  }
+  wake.notify_one();
+  flusher.join();
+  flush();
+  std::fclose(file);
+  file = nullptr;
+}
+
+RingTracer::CurrentRing::~CurrentRing() {
+  if (!ring) {
+    return;
+  }
+  // A full ring is drained by the flusher (if the tracer still exists), the wait is bounded:
+  const Record marker{ticks(), 0, 0, 0, TYPEART_UNKNOWN_TYPE, thread, EventKind::dropped, 0};
+  for (unsigned attempt = 0; !ring->pushDropped(marker) && attempt < ExitWaitAttempts; ++attempt) {
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+  }
+  ring->orphaned.store(true, std::memory_order_release);
+}
+
+void RingTracer::registerThread(CurrentRing& current) {
+  if (current.ring) {
+    // Registered with another (previous) tracer:
+    current.ring->orphaned.store(true, std::memory_order_release);
+  }
+  std::lock_guard<std::mutex> lock(ringsMutex);
+  // Rings of exited threads are taken over (with their pending records), otherwise, thread churn would grow the trace
+  // memory without bound:
+  // The thread index is the index of the ring, i.e., bounded by the number of concurrently running threads:
+  size_t index{0};
+  while (index < rings.size() && !rings[index]->orphaned.load(std::memory_order_acquire)) {
+    ++index;
+  }
+  if (index == rings.size()) {
+    rings.emplace_back(std::make_shared<EventRing>());
+  } else {
+    rings[index]->orphaned.store(false, std::memory_order_relaxed);
+  }
+  current.tracer = instanceId;
+  current.ring   = rings[index];
+  current.thread = static_cast<uint16_t>(index);
+}
+
+void RingTracer::flush() {
+  if (file == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> file_lock(fileMutex);
+  std::vector<std::shared_ptr<EventRing>> current_rings;
+  {
+    // Threads register (with their first event) without waiting for the write:
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    current_rings = rings;
+  }
+  for (const auto& ring : current_rings) {
+    ring->drain([&](const Record* records, size_t count) { std::fwrite(records, sizeof(Record), count, file); });
+  }
+  writeClock();
+  std::fflush(file);
+}
+
+void RingTracer::writeClock() {
+  const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  const Record clock{ticks(), 0, static_cast<uint64_t>(elapsed.count()), 0, 0, 0, EventKind::clock, 0};
+  std::fwrite(&clock, sizeof(clock), 1, file);
+}
+
+void RingTracer::flushLoop() {
+  std::unique_lock<std::mutex> lock(wakeMutex);
+  while (!stop) {
+    wake.wait_for(lock, FlushInterval);
+    lock.unlock();
+    flush();
+    lock.lock();
+  }
+}
+
+}  // namespace typeart::trace
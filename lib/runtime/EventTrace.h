@@ -0,0 +1,257 @@
+// TypeART library
+//
+// Copyright (c) 2017-2022 TypeART Authors
+// Distributed under the BSD 3-Clause license.
+// (See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/BSD-3-Clause)
+//
+// Project home: https://github.com/tudasc/TypeART
+//
+// SPDX-License-Identifier: BSD-3-Clause
+//
+
+#ifndef TYPEART_EVENTTRACE_H
+#define TYPEART_EVENTTRACE_H
+
+#include "TraceFormat.h"
+#include "TypeInterface.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace typeart::trace {
+
+/**
+ * Fixed-size ring of trace records with a single producer (the owning thread) and a single consumer (the flusher).
+ * A full ring drops records (counted, and reported with the next record), the producer never waits.
+ */
+class EventRing final {
+ public:
+  static constexpr uint64_t Capacity = uint64_t{1} << 12;
+
+  inline void push(const Record& record) {
+    if (dropped != 0) {
+      if (!reserve(2)) {
+        ++dropped;
+        return;
+      }
+      Record lost{record};
+      lost.kind   = EventKind::dropped;
+      lost.count  = dropped;
+      lost.status = 0;
+      write(lost);
+      dropped = 0;
+    } else if (!reserve(1)) {
+      ++dropped;
+      return;
+    }
+    write(record);
+  }
+
+  /**
+   * Reports the records dropped since the last pushed record (e.g., on exit of the producer).
+   * @return false, if there is no room for the report (yet).
+   */
+  inline bool pushDropped(Record marker) {
+    if (dropped == 0) {
+      return true;
+    }
+    if (!reserve(1)) {
+      return false;
+    }
+    marker.kind   = EventKind::dropped;
+    marker.count  = dropped;
+    marker.status = 0;
+    write(marker);
+    dropped = 0;
+    return true;
+  }
+
+  /**
+   * True, if the ring just became half full (the flusher should be woken).
+   */
+  [[nodiscard]] inline bool reachedHalf() const {
+    return head.load(std::memory_order_relaxed) - cachedTail == Capacity / 2;
+  }
+
+  /**
+   * Consumer: passes the pending records (at most two contiguous blocks) to consume, and releases them.
+   */
+  template <typename Consume>
+  size_t drain(Consume&& consume) {
+    const uint64_t first = tail.load(std::memory_order_relaxed);
+    const uint64_t last  = head.load(std::memory_order_acquire);
+    if (first == last) {
+      return 0;
+    }
+    const uint64_t begin = first & (Capacity - 1);
+    const uint64_t end   = last & (Capacity - 1);
+    if (begin < end) {
+      consume(&records[begin], end - begin);
+    } else {
+      consume(&records[begin], Capacity - begin);
+      if (end > 0) {
+        consume(&records[0], end);
+      }
+    }
+    tail.store(last, std::memory_order_release);
+    return last - first;
+  }
+
+  [[nodiscard]] bool empty() const {
+    return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+  }
+
+  // Set by the owning thread on exit, the ring is then taken over by the next new thread. Records pending at that point
+  // are kept, and drained before the records of the new thread.
+  std::atomic<bool> orphaned{false};
+
+ private:
+  inline bool reserve(uint64_t count) {
+    const uint64_t position = head.load(std::memory_order_relaxed);
+    if (position + count - cachedTail > Capacity) {
+      cachedTail = tail.load(std::memory_order_acquire);
+      return position + count - cachedTail <= Capacity;
+    }
+    return true;
+  }
+
+  inline void write(const Record& record) {
+    const uint64_t position             = head.load(std::memory_order_relaxed);
+    records[position & (Capacity - 1)] = record;
+    head.store(position + 1, std::memory_order_release);
+  }
+
+  std::array<Record, Capacity> records;
+  alignas(64) std::atomic<uint64_t> head{0};
+  uint64_t cachedTail{0};
+  uint64_t dropped{0};
+  alignas(64) std::atomic<uint64_t> tail{0};
+};
+
+/**
+ * Records runtime events to per-thread rings, a background thread writes them to the file TYPEART_TRACE_FILE ("%p" is
+ * replaced with the process ID). Without the env variable, tracing is disabled.
+ */
+class RingTracer final {
+ public:
+  RingTracer();
+
+  RingTracer(const RingTracer&) = delete;
+
+  RingTracer& operator=(const RingTracer&) = delete;
+
+  ~RingTracer();
+
+  inline void record(EventKind kind, const void* addr, int type_id, size_t count, const void* site, unsigned status) {
+    if (file == nullptr) {
+      return;
+    }
+    auto& current = currentRing();
+    current.ring->push(Record{ticks(), reinterpret_cast<uint64_t>(addr), count, reinterpret_cast<uint64_t>(site),
+                              type_id, current.thread, kind, static_cast<uint8_t>(status)});
+    if (current.ring->reachedHalf()) {
+      wake.notify_one();
+    }
+  }
+
+  [[nodiscard]] bool enabled() const {
+    return file != nullptr;
+  }
+
+  /**
+   * Writes all pending records (of all threads) to the trace file.
+   */
+  void flush();
+
+ private:
+  struct CurrentRing {
+    uint64_t tracer{0};
+    std::shared_ptr<EventRing> ring;
+    uint16_t thread{0};
+
+    ~CurrentRing();
+  };
+
+  inline CurrentRing& currentRing() {
+    static thread_local CurrentRing current;
+    if (current.tracer != instanceId) {
+      registerThread(current);
+    }
+    return current;
+  }
+
+  /**
+   * Clock ticks, the time stamp counter is several times cheaper to read than the steady clock.
+   */
+  [[nodiscard]] static inline uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+  }
+
+  // Relates the ticks of records to the nanoseconds since the trace start, must hold the file (see fileMutex):
+  void writeClock();
+
+  void registerThread(CurrentRing& current);
+
+  void flushLoop();
+
+  // Distinguishes tracers in the thread-local ring cache, (unlike the address) it is never reused.
+  const uint64_t instanceId;
+  std::FILE* file{nullptr};
+  const std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+
+  std::mutex ringsMutex;
+  std::vector<std::shared_ptr<EventRing>> rings;
+
+  // Serializes writes to the file (flusher and explicit flush calls):
+  std::mutex fileMutex;
+
+  std::mutex wakeMutex;
+  std::condition_variable wake;
+  bool stop{false};
+  std::thread flusher;
+};
+
+/**
+ * Used for no-operations when the event trace is not built.
+ */
+class NoneTracer final {
+ public:
+  [[maybe_unused]] inline void record(EventKind, const void*, int, size_t, const void*, unsigned) {
+  }
+  [[maybe_unused]] [[nodiscard]] bool enabled() const {
+    return false;
+  }
+  [[maybe_unused]] void flush() {
+  }
+};
+
+}  // namespace typeart::trace
+
+namespace typeart {
+#ifdef TYPEART_EVENT_TRACE
+using EventTracer = trace::RingTracer;
+#else
+using EventTracer = trace::NoneTracer;
+#endif
+}  // namespace typeart
+
+#endif  // TYPEART_EVENTTRACE_H
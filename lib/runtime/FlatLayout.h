@@ -0,0 +1,151 @@
+// TypeART library
+//
+// Copyright (c) 2017-2022 TypeART Authors
+// Distributed under the BSD 3-Clause license.
+// (See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/BSD-3-Clause)
+//
+// Project home: https://github.com/tudasc/TypeART
+//
+// SPDX-License-Identifier: BSD-3-Clause
+//
+
+#ifndef TYPEART_FLATLAYOUT_H
+#define TYPEART_FLATLAYOUT_H
+
+#include "TypeDB.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace typeart {
+
+/**
+ * Member arrays of one element of a struct type, with nested (single element) structs inlined, sorted by byte offset.
+ * Resolving an interior offset is a binary search for the segment, instead of a member scan per nesting level.
+ */
+class FlatLayout final {
+ public:
+  struct Segment {
+    size_t begin{0};
+    size_t stride{0};
+    size_t count{0};
+    int type_id{-1};
+    // Outermost type starting at begin, i.e., the single element struct that contains this segment first:
+    int anchor_type_id{-1};
+    size_t anchor_count{0};
+    // Struct array, interior offsets of an element are resolved with the layout of type_id:
+    bool nested{false};
+  };
+
+ private:
+  std::vector<size_t> begins_;
+  std::vector<Segment> segments_;
+
+ public:
+  FlatLayout() = default;
+
+  explicit FlatLayout(std::vector<Segment> segments) : segments_(std::move(segments)) {
+    begins_.reserve(segments_.size());
+    std::transform(segments_.begin(), segments_.end(), std::back_inserter(begins_),
+                   [](const Segment& segment) { return segment.begin; });
+  }
+
+  /**
+   * @return The segment containing offset, or nullptr if offset points to padding.
+   */
+  [[nodiscard]] const Segment* find(size_t offset) const {
+    const auto it = std::upper_bound(begins_.begin(), begins_.end(), offset);
+    if (it == begins_.begin()) {
+      return nullptr;
+    }
+    const auto& segment = segments_[std::distance(begins_.begin(), it) - 1];
+    if (offset - segment.begin >= segment.stride * segment.count) {
+      return nullptr;
+    }
+    return &segment;
+  }
+
+  [[nodiscard]] size_t size() const {
+    return segments_.size();
+  }
+};
+
+/**
+ * Flattened layouts of all struct types of the type database, built once the types are registered.
+ * Types with an irregular layout (e.g., overlapping or unsorted members, unknown member types) have no flattened
+ * layout, and are resolved member by member instead.
+ * Layouts are immutable once built, copies share them.
+ */
+class FlatLayouts final {
+  static constexpr unsigned MaxInlineDepth{8};
+
+  std::unordered_map<int, std::shared_ptr<const FlatLayout>> layouts_;
+
+  static bool flatten(const TypeDB& db, const StructTypeInfo& info, size_t base, unsigned depth,
+                      std::vector<FlatLayout::Segment>& segments) {
+    if (info.num_members == 0 || info.offsets.empty() || info.offsets.front() != 0) {
+      return false;
+    }
+    size_t previous_end{0};
+    for (size_t index = 0; index < info.num_members; ++index) {
+      const int type_id   = info.member_types[index];
+      const size_t offset = info.offsets[index];
+      const size_t count  = info.array_sizes[index];
+      const size_t stride = db.getTypeSize(type_id);
+      if (stride == 0 || count == 0 || offset < previous_end) {
+        return false;
+      }
+      previous_end = offset + stride * count;
+      if (previous_end > info.extent) {
+        return false;
+      }
+
+      const auto* nested_info = db.getStructInfo(type_id);
+      if (nested_info != nullptr && count == 1 && depth < MaxInlineDepth) {
+        const size_t first = segments.size();
+        if (flatten(db, *nested_info, base + offset, depth + 1, segments)) {
+          segments[first].anchor_type_id = type_id;
+          segments[first].anchor_count   = 1;
+          continue;
+        }
+        segments.resize(first);
+      }
+      segments.push_back(FlatLayout::Segment{base + offset, stride, count, type_id, type_id, count,
+                                             nested_info != nullptr});
+    }
+    return true;
+  }
+
+ public:
+  /**
+   * Builds the layouts of the (newly registered) struct types type_ids of db.
+   */
+  void add(const TypeDB& db, const std::vector<int>& type_ids) {
+    for (const int type_id : type_ids) {
+      const auto* info = db.getStructInfo(type_id);
+      std::vector<FlatLayout::Segment> segments;
+      if (info != nullptr && flatten(db, *info, 0, 0, segments)) {
+        layouts_.emplace(type_id, std::make_shared<const FlatLayout>(std::move(segments)));
+      }
+    }
+  }
+
+  [[nodiscard]] const FlatLayout* lookup(int type_id) const {
+    const auto it = layouts_.find(type_id);
+    return it != layouts_.end() ? it->second.get() : nullptr;
+  }
+
+  [[nodiscard]] size_t size() const {
+    return layouts_.size();
+  }
+};
+
+}  // namespace typeart
+
+#endif  // TYPEART_FLATLAYOUT_H
@@ -0,0 +1,190 @@
+// TypeART library
+//
+// Copyright (c) 2017-2022 TypeART Authors
+// Distributed under the BSD 3-Clause license.
+// (See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/BSD-3-Clause)
+//
+// Project home: https://github.com/tudasc/TypeART
+//
+// SPDX-License-Identifier: BSD-3-Clause
+//
+
+#ifndef TYPEART_GLOBALTABLE_H
+#define TYPEART_GLOBALTABLE_H
+
+#include "RuntimeData.h"
+
+#include "llvm/ADT/Optional.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace typeart {
+
+/**
+ * Index of global allocations, which are registered (by module constructors) but never freed.
+ * Registrations are collected in a pending batch. The first query afterwards merges the sorted batch with the current
+ * immutable snapshot into a new one, which is searched without locks. Replaced snapshots (e.g., after a dlopen-ed
+ * module registered its globals) are freed once no reader may still use them: Readers announce themselves in a reader
+ * slot (by thread) for the duration of a query.
+ */
+class GlobalTable final {
+  struct Snapshot {
+    std::vector<MemAddr> bases;
+    std::vector<PointerInfo> infos;
+  };
+
+  struct alignas(64) ReaderSlot {
+    std::atomic<size_t> count{0};
+  };
+
+  static constexpr size_t num_reader_slots = 16;
+
+  std::atomic<const Snapshot*> frozen_{nullptr};
+  std::atomic<bool> dirty_{false};
+  // Address range of all bases, checked without announcing a reader:
+  std::atomic<uintptr_t> lower_{UINTPTR_MAX};
+  std::atomic<uintptr_t> upper_{0};
+  std::array<ReaderSlot, num_reader_slots> readers_;
+  std::unique_ptr<const Snapshot> current_;
+  std::vector<std::unique_ptr<const Snapshot>> retired_;
+  std::unordered_map<MemAddr, PointerInfo> pending_;
+  std::mutex table_m_;
+
+  [[nodiscard]] ReaderSlot& readerSlot() {
+    static std::atomic<size_t> next_slot{0};
+    thread_local const size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed) % num_reader_slots;
+    return readers_[slot];
+  }
+
+  void freeze() {
+    std::lock_guard<std::mutex> guard(table_m_);
+    if (!dirty_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    std::vector<std::pair<MemAddr, PointerInfo>> batch(pending_.begin(), pending_.end());
+    std::sort(batch.begin(), batch.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+    pending_.clear();
+
+    // Linear merge with the current snapshot, a registration replaces the previous entry of the same base:
+    static const Snapshot empty;
+    const Snapshot& previous = current_ ? *current_ : empty;
+    auto snapshot            = std::make_unique<Snapshot>();
+    snapshot->bases.reserve(previous.bases.size() + batch.size());
+    snapshot->infos.reserve(previous.bases.size() + batch.size());
+    size_t index{0};
+    auto next = batch.begin();
+    while (index < previous.bases.size() || next != batch.end()) {
+      if (next == batch.end() || (index < previous.bases.size() && previous.bases[index] < next->first)) {
+        snapshot->bases.push_back(previous.bases[index]);
+        snapshot->infos.push_back(previous.infos[index]);
+        ++index;
+        continue;
+      }
+      if (index < previous.bases.size() && previous.bases[index] == next->first) {
+        ++index;
+      }
+      snapshot->bases.push_back(next->first);
+      snapshot->infos.push_back(next->second);
+      ++next;
+    }
+
+    if (!snapshot->bases.empty()) {
+      lower_.store(reinterpret_cast<uintptr_t>(snapshot->bases.front()), std::memory_order_relaxed);
+      upper_.store(reinterpret_cast<uintptr_t>(snapshot->bases.back()), std::memory_order_relaxed);
+    }
+    frozen_.store(snapshot.get(), std::memory_order_seq_cst);
+    if (current_) {
+      retired_.emplace_back(std::move(current_));
+    }
+    current_ = std::move(snapshot);
+    dirty_.store(false, std::memory_order_release);
+    reclaim();
+  }
+
+  void reclaim() {
+    // A reader of a retired snapshot announced itself before loading it, i.e., before it was replaced. Readers
+    // announcing themselves afterwards load the current snapshot:
+    const bool quiescent = std::all_of(readers_.begin(), readers_.end(), [](const ReaderSlot& slot) {
+      return slot.count.load(std::memory_order_seq_cst) == 0;
+    });
+    if (quiescent) {
+      retired_.clear();
+    }
+  }
+
+  /**
+   * Index of the greatest base <= addr, bases must be non-empty. Branch-free, the loop trip count only depends on the
+   * size of the table.
+   */
+  [[nodiscard]] static size_t search(const std::vector<MemAddr>& bases, MemAddr addr) {
+    const MemAddr* first = bases.data();
+    size_t length        = bases.size();
+    while (length > 1) {
+      const size_t half = length / 2;
+      first             = (first[half] <= addr) ? first + half : first;
+      length -= half;
+    }
+    return static_cast<size_t>(first - bases.data());
+  }
+
+ public:
+  /**
+   * @return true, if addr was already registered.
+   */
+  [[nodiscard]] bool put(MemAddr addr, const PointerInfo& info) {
+    std::lock_guard<std::mutex> guard(table_m_);
+    const auto [it, inserted] = pending_.insert_or_assign(addr, info);
+    dirty_.store(true, std::memory_order_release);
+    if (!inserted) {
+      return true;
+    }
+    const auto* snapshot = current_.get();
+    return snapshot != nullptr && !snapshot->bases.empty() && addr >= snapshot->bases.front() &&
+           snapshot->bases[search(snapshot->bases, addr)] == addr;
+  }
+
+  [[nodiscard]] llvm::Optional<RuntimeT::MapEntry> find(MemAddr addr) {
+    if (dirty_.load(std::memory_order_acquire)) {
+      freeze();
+    }
+    auto& reader = readerSlot();
+    reader.count.fetch_add(1, std::memory_order_seq_cst);
+    llvm::Optional<RuntimeT::MapEntry> entry;
+    const auto* snapshot = frozen_.load(std::memory_order_seq_cst);
+    if (snapshot != nullptr && !snapshot->bases.empty() && addr >= snapshot->bases.front()) {
+      const auto index = search(snapshot->bases, addr);
+      entry.emplace(snapshot->bases[index], snapshot->infos[index]);
+    }
+    reader.count.fetch_sub(1, std::memory_order_release);
+    return entry;
+  }
+
+  /**
+   * @return true, if addr is the base of a registered global allocation (e.g., a heap allocation of a custom allocator
+   * at the address of a global buffer).
+   */
+  [[nodiscard]] bool contains_base(MemAddr addr) {
+    if (!dirty_.load(std::memory_order_acquire)) {
+      const auto address = reinterpret_cast<uintptr_t>(addr);
+      if (address < lower_.load(std::memory_order_relaxed) || address > upper_.load(std::memory_order_relaxed)) {
+        return false;
+      }
+    }
+    const auto entry = find(addr);
+    return entry && entry->first == addr;
+  }
+};
+
+}  // namespace typeart
+
+#endif  // TYPEART_GLOBALTABLE_H
@@ -0,0 +1,59 @@
+// TypeART library
+//
+// Copyright (c) 2017-2022 TypeART Authors
+// Distributed under the BSD 3-Clause license.
+// (See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/BSD-3-Clause)
+//
+// Project home: https://github.com/tudasc/TypeART
+//
+// SPDX-License-Identifier: BSD-3-Clause
+//
+
+#ifndef TYPEART_LAZYTYPELOADER_H
+#define TYPEART_LAZYTYPELOADER_H
+
+#include "TypeInterface.h"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <utility>
+
+namespace typeart {
+
+/**
+ * Loads the user-defined types (the type file) once, on first use of a user-defined type ID.
+ * Built-in type IDs are known without the type file and never wait for it.
+ */
+class LazyTypeLoader final {
+  std::atomic<bool> loaded_{false};
+  std::mutex mutex_;
+  std::function<void()> load_;
+
+ public:
+  explicit LazyTypeLoader(std::function<void()> load) : load_(std::move(load)) {
+  }
+
+  void require(int type_id) {
+    if (type_id < TYPEART_NUM_RESERVED_IDS) {
+      return;
+    }
+    requireAll();
+  }
+
+  void requireAll() {
+    if (loaded_.load(std::memory_order_acquire)) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!loaded_.load(std::memory_order_relaxed)) {
+      load_();
+      loaded_.store(true, std::memory_order_release);
+    }
+  }
+};
+
+}  // namespace typeart
+
+#endif  // TYPEART_LAZYTYPELOADER_H
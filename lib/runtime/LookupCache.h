@@ -0,0 +1,175 @@
+// TypeART library
+//
+// Copyright (c) 2017-2022 TypeART Authors
+// Distributed under the BSD 3-Clause license.
+// (See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/BSD-3-Clause)
+//
+// Project home: https://github.com/tudasc/TypeART
+//
+// SPDX-License-Identifier: BSD-3-Clause
+//
+
+#ifndef TYPEART_LOOKUPCACHE_H
+#define TYPEART_LOOKUPCACHE_H
+
+#include "RuntimeData.h"
+
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallPtrSet.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+#ifndef TYPEART_LOOKUP_CACHE_SIZE
+#define TYPEART_LOOKUP_CACHE_SIZE 4
+#endif
+
+namespace typeart {
+
+/**
+ * Global modification counter, incremented whenever a tracked allocation is removed, overridden, or another allocation
+ * is registered inside of it.
+ * Cached lookups of any thread are only valid for the epoch they were resolved in.
+ */
+class ModificationEpoch final {
+  std::atomic<uint64_t> epoch_{0};
+
+ public:
+  [[nodiscard]] uint64_t current() const {
+    return epoch_.load(std::memory_order_acquire);
+  }
+
+  void bump() {
+    epoch_.fetch_add(1, std::memory_order_release);
+  }
+};
+
+/**
+ * Base addresses of live heap allocations registered inside of another live heap allocation (e.g., after a missed
+ * free). Extents are only checked for nested entries before caching while this set is non-empty.
+ */
+class NestedAllocations final {
+  llvm::SmallPtrSet<MemAddr, 8> bases_;
+  std::atomic<size_t> size_{0};
+  std::mutex nested_m_;
+
+ public:
+  [[nodiscard]] bool empty() const {
+    return size_.load(std::memory_order_acquire) == 0;
+  }
+
+  void insert(MemAddr addr) {
+    std::lock_guard<std::mutex> guard(nested_m_);
+    bases_.insert(addr);
+    size_.store(bases_.size(), std::memory_order_release);
+  }
+
+  void erase(MemAddr addr) {
+    if (empty()) {
+      return;
+    }
+    std::lock_guard<std::mutex> guard(nested_m_);
+    bases_.erase(addr);
+    size_.store(bases_.size(), std::memory_order_release);
+  }
+};
+
+/**
+ * Per-thread cache of the last few resolved base allocations (most recent first).
+ * Entries cover the full extent [base, base + extent) of an allocation. Extents containing other allocations (nested,
+ * e.g., after a missed free) are not cached, hence, an address inside a cached extent resolves to the same base as a
+ * map lookup would.
+ */
+template <unsigned Size>
+class LookupCache final {
+  struct Entry {
+    const char* begin{nullptr};
+    const char* end{nullptr};
+    PointerInfo info{};
+  };
+
+  std::array<Entry, Size> entries_{};
+  uint64_t epoch_{0};
+
+ public:
+  static constexpr bool enabled{true};
+
+  [[nodiscard]] llvm::Optional<RuntimeT::MapEntry> find(MemAddr addr, uint64_t epoch) {
+    if (epoch != epoch_) {
+      clear();
+      epoch_ = epoch;
+      return llvm::None;
+    }
+    const auto* address = static_cast<const char*>(addr);
+    for (unsigned index = 0; index < Size; ++index) {
+      const auto& entry = entries_[index];
+      if (entry.begin <= address && address < entry.end) {
+        const RuntimeT::MapEntry result{entry.begin, entry.info};
+        if (index > 0) {
+          std::swap(entries_[index], entries_[index - 1]);
+        }
+        return result;
+      }
+    }
+    return llvm::None;
+  }
+
+  void insert(const RuntimeT::MapEntry& resolved, size_t extent, uint64_t epoch) {
+    if (epoch != epoch_) {
+      // The allocation was resolved in an outdated epoch, it may have been removed since then.
+      return;
+    }
+    for (unsigned index = Size - 1; index > 0; --index) {
+      entries_[index] = entries_[index - 1];
+    }
+    const auto* begin = static_cast<const char*>(resolved.first);
+    entries_[0]       = Entry{begin, begin + extent, resolved.second};
+  }
+
+  /**
+   * Drops the entry of the allocation at base, e.g., a stack allocation removed without an epoch change.
+   */
+  void erase(MemAddr base) {
+    for (auto& entry : entries_) {
+      if (entry.begin == base) {
+        entry = Entry{};
+      }
+    }
+  }
+
+  void clear() {
+    entries_.fill(Entry{});
+  }
+};
+
+struct NoLookupCache final {
+  static constexpr bool enabled{false};
+
+  [[nodiscard]] llvm::Optional<RuntimeT::MapEntry> find(MemAddr, uint64_t) {
+    return llvm::None;
+  }
+
+  void insert(const RuntimeT::MapEntry&, size_t, uint64_t) {
+  }
+
+  void erase(MemAddr) {
+  }
+
+  void clear() {
+  }
+};
+
+#ifdef TYPEART_LOOKUP_CACHE
+using ThreadLookupCache = LookupCache<TYPEART_LOOKUP_CACHE_SIZE>;
+#else
+using ThreadLookupCache = NoLookupCache;
+#endif
+
+}  // namespace typeart
+
+#endif  // TYPEART_LOOKUPCACHE_H
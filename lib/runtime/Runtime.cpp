@@ -14,16 +14,22 @@
 
 #include "AccessCountPrinter.h"
 #include "AccessCounter.h"
+#include "CallSiteTable.h"
+#include "CallbackInterface.h"
 #include "RuntimeData.h"
 #include "TypeIO.h"
 #include "support/Logger.h"
 
+#include "llvm/Support/FileSystem.h"
+
 //#include "llvm/Support/raw_ostream.h"
 
+#include <atomic>
 #include <cstdlib>
 #include <iostream>
 #include <set>
 #include <sstream>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -45,7 +51,7 @@ std::string toString(const void* memAddr, int typeId, size_t count, const void*
 }
 
 std::string toString(const void* addr, const PointerInfo& info) {
-  return toString(addr, info.typeId, info.count, info.debug);
+  return toString(addr, info.typeId, info.count, return_address_of(info));
 }
 
 inline void printTraceStart() {
@@ -59,11 +65,44 @@ inline void printTraceStart() {
 
 static constexpr const char* defaultTypeFileName = "types.yaml";
 
-RuntimeSystem::RuntimeSystem() : rtScopeInit(), typeResolution(typeDB, recorder), allocTracker(typeDB, recorder) {
+// Set by the first embedded type table, before the runtime is initialized by the same call:
+static std::atomic<bool> hasEmbeddedTypes{false};
+
+static const char* typeFileFromEnv() {
+  const char* type_file = std::getenv("TYPEART_TYPE_FILE");
+  if (type_file == nullptr) {
+    // FIXME Deprecated name
+    type_file = std::getenv("TA_TYPE_FILE");
+  }
+  return type_file;
+}
+
+RuntimeSystem::RuntimeSystem()
+    : rtScopeInit(),
+      typeLoader([this] { loadTypes(); }),
+      typeResolution(typeRegistry, typeLoader, recorder),
+      allocTracker(typeRegistry, typeLoader, recorder, tracer) {
   debug::printTraceStart();
+  // The type file is loaded on first use of a user-defined type, see loadTypes. A missing type file (set explicitly)
+  // is still reported at startup:
+  if (const char* type_file = typeFileFromEnv(); type_file != nullptr) {
+    if (std::getenv("TYPEART_TYPE_FILE") == nullptr) {
+      LOG_WARNING("Use of deprecated env var TA_TYPE_FILE.");
+    }
+    if (const auto error = llvm::sys::fs::access(type_file, llvm::sys::fs::AccessMode::Exist); error) {
+      LOG_FATAL("Failed to load recorded types from TYPEART_TYPE_FILE=" << type_file
+                                                                        << ". Reason: " << error.message());
+      std::exit(EXIT_FAILURE);  // TODO: Error handling
+    }
+  }
+  rtScopeInit.reset();
+}
 
-  auto loadTypes = [this](const std::string& file, std::error_code& ec) -> bool {
-    auto loaded = io::load(&typeDB, file);
+void RuntimeSystem::loadTypes() {
+  // Embedded types may already be registered, hence, the type file is merged:
+  TypeDB fileTypes;
+  auto loadTypes = [&fileTypes](const std::string& file, std::error_code& ec) -> bool {
+    auto loaded = io::load(&fileTypes, file);
     ec          = loaded.getError();
     return !static_cast<bool>(ec);
   };
@@ -71,20 +110,15 @@ RuntimeSystem::RuntimeSystem() : rtScopeInit(), typeResolution(typeDB, recorder)
   std::error_code error;
   // Try to load types from specified file first.
   // Then look at default location.
-  const char* type_file = std::getenv("TYPEART_TYPE_FILE");
-  if (type_file == nullptr) {
-    // FIXME Deprecated name
-    type_file = std::getenv("TA_TYPE_FILE");
-    if (type_file != nullptr) {
-      LOG_WARNING("Use of deprecated env var TA_TYPE_FILE.");
-    }
-  }
+  const char* type_file = typeFileFromEnv();
   if (type_file != nullptr) {
     if (!loadTypes(type_file, error)) {
       LOG_FATAL("Failed to load recorded types from TYPEART_TYPE_FILE=" << type_file
                                                                         << ". Reason: " << error.message());
       std::exit(EXIT_FAILURE);  // TODO: Error handling
     }
+  } else if (hasEmbeddedTypes.load(std::memory_order_acquire)) {
+    LOG_DEBUG("Using embedded types, no type file is loaded.");
   } else {
     if (!loadTypes(defaultTypeFileName, error)) {
       LOG_WARNING(
@@ -96,19 +130,48 @@ RuntimeSystem::RuntimeSystem() : rtScopeInit(), typeResolution(typeDB, recorder)
     }
   }
 
-  std::stringstream ss;
-  const auto& typeList = typeDB.getStructList();
-  for (const auto& structInfo : typeList) {
-    ss << structInfo.name << ", ";
+  size_t registered{0};
+  for (const int type_id : typeRegistry.merge(fileTypes, &registered)) {
+    LOG_ERROR("Type " << fileTypes.getTypeName(type_id) << " of the type file conflicts with embedded type "
+                      << typeRegistry.db().getTypeName(type_id) << " (ID " << type_id << ").");
+  }
+  recorder.incUDefTypes(registered);
+
+  if constexpr (TYPEART_LOG_LEVEL >= 2) {
+    // Diagnostics only, not built unless the info log level is enabled:
+    std::string names;
+    llvm::raw_string_ostream stream(names);
+    for (const auto& structInfo : typeRegistry.db().getStructList()) {
+      stream << structInfo.name << ", ";
+    }
+    LOG_INFO("Recorded types: " << stream.str());
   }
-  recorder.incUDefTypes(typeList.size());
-  LOG_INFO("Recorded types: " << ss.str());
-  rtScopeInit.reset();
+}
+
+bool RuntimeSystem::registerTypes(const void* table, size_t size) {
+  TypeDB embedded;
+  const auto loaded = io::load_binary(&embedded, llvm::StringRef{static_cast<const char*>(table), size});
+  if (!loaded) {
+    LOG_ERROR("Invalid embedded type table at " << table << ". Reason: " << loaded.getError().message());
+    return false;
+  }
+
+  // Types shared by several modules are embedded in each of them:
+  size_t registered{0};
+  for (const int type_id : typeRegistry.merge(embedded, &registered)) {
+    LOG_ERROR("Embedded type " << embedded.getTypeName(type_id) << " conflicts with type "
+                               << typeRegistry.db().getTypeName(type_id) << " (ID " << type_id << ").");
+  }
+  recorder.incUDefTypes(registered);
+  LOG_DEBUG("Registered " << registered << " embedded types.");
+  return true;
 }
 
 RuntimeSystem::~RuntimeSystem() {
   rtScope = true;
 
+  allocTracker.flush();
+
   //  std::string stats;
   //  llvm::raw_string_ostream stream(stats);
 
@@ -124,3 +187,9 @@ RuntimeSystem::~RuntimeSystem() {
 thread_local bool RuntimeSystem::rtScope = false;
 
 }  // namespace typeart
+
+void __typeart_register_types(const void* table, size_t size) {
+  typeart::hasEmbeddedTypes.store(true, std::memory_order_release);
+  typeart::RTGuard guard;
+  typeart::RuntimeSystem::get().registerTypes(table, size);
+}
@@ -15,7 +15,9 @@
 
 #include "AccessCounter.h"
 #include "AllocationTracking.h"
-#include "TypeDB.h"
+#include "EventTrace.h"
+#include "LazyTypeLoader.h"
+#include "TypeRegistry.h"
 #include "TypeResolution.h"
 
 #include <cstddef>
@@ -53,15 +55,24 @@ struct RuntimeSystem {
   };
 
   RTScopeInitializer rtScopeInit;
-  TypeDB typeDB{};
+  TypeRegistry typeRegistry{};
+  LazyTypeLoader typeLoader;
 
  public:
   Recorder recorder{};
+  EventTracer tracer{};
   TypeResolution typeResolution;
   AllocationTracker allocTracker;
 
   static thread_local bool rtScope;
 
+  /**
+   * Merges an embedded type table into the type database. Tables are registered by module constructors, including
+   * those of dlopen-ed modules, i.e., concurrently to queries of other threads (see TypeRegistry).
+   * @return false, if the table is invalid.
+   */
+  bool registerTypes(const void* table, size_t size);
+
   static RuntimeSystem& get() {
     // As opposed to a global variable, a singleton + instantiation during
     // the first callback/query avoids some problems when
@@ -73,6 +84,8 @@ struct RuntimeSystem {
  private:
   RuntimeSystem();
   ~RuntimeSystem();
+
+  void loadTypes();
 };
 
 struct RTGuard final {
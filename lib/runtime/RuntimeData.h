@@ -46,17 +46,27 @@
 #endif
 
 #include <cstddef>  // size_t
+#include <cstdint>
 #include <vector>
 
 namespace typeart {
 
 using MemAddr = const void*;
 
+#ifdef TYPEART_COMPACT_POINTER_INFO
+struct PointerInfo final {
+  int typeId{-1};
+  uint32_t site{0};  // Index into the CallSiteTable
+  size_t count{0};
+};
+static_assert(sizeof(PointerInfo) == 16, "Compact PointerInfo layout must not exceed 16 bytes");
+#else
 struct PointerInfo final {
   int typeId{-1};
   size_t count{0};
   MemAddr debug{nullptr};
 };
+#endif
 
 struct RuntimeT {
   using Stack = std::vector<MemAddr>;
@@ -17,9 +17,11 @@
 
 #ifdef __cplusplus
 #include <cstddef>
+#include <cstdint>
 #else
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #endif
 
 #ifdef __cplusplus
@@ -79,6 +81,25 @@ typedef struct typeart_struct_layout_t {  // NOLINT
  */
 typeart_status typeart_get_type(const void* addr, int* type_id, size_t* count);
 
+/**
+ * Batched version of typeart_get_type for num_addrs addresses, e.g., all displacements of a derived datatype.
+ * The addresses are resolved together, taking the allocation lock only once, and may be passed in any order.
+ *
+ * \param[in] addrs The addresses.
+ * \param[in] num_addrs Number of addresses.
+ * \param[out] type_ids Type ID per address.
+ * \param[out] counts Allocation size per address.
+ * \param[out] statuses Status per address, see typeart_get_type. The type_ids and counts entries are only valid if
+ * TYPEART_OK.
+ *
+ * \return A status code:
+ *  - TYPEART_OK: All queries were successful.
+ *  - TYPEART_ERROR: One of the arrays is NULL.
+ *  - Otherwise, the status of the first (in order of addrs) unsuccessful query.
+ */
+typeart_status typeart_get_types(const void* const* addrs, size_t num_addrs, int* type_ids, size_t* counts,
+                                 typeart_status* statuses);
+
 typeart_status typeart_get_type_length(const void* addr, size_t* count);
 
 typeart_status typeart_get_type_id(const void* addr, int* type_id);
@@ -130,6 +151,35 @@ typeart_status typeart_get_type_id(const void* addr, int* type_id);
 typeart_status typeart_get_containing_type(const void* addr, int* type_id, size_t* count, const void** base_address,
                                            size_t* byte_offset);
 
+typedef struct typeart_query_result_t {  // NOLINT
+  const void* base_address;
+  int containing_type_id;
+  size_t containing_count;
+  size_t byte_offset;
+  typeart_status type_status;
+  int type_id;
+  size_t count;
+  typeart_struct_layout layout;
+} typeart_query_result;
+
+/**
+ * Combines typeart_get_containing_type, typeart_get_type and typeart_resolve_type_id with a single lookup of the
+ * allocation containing the address.
+ *
+ * \param[in] addr The address.
+ * \param[out] result The query result:
+ *  - base_address, containing_type_id, containing_count, byte_offset: See typeart_get_containing_type.
+ *  - type_status: Status of resolving the innermost type, see typeart_get_type.
+ *  - type_id, count: The innermost type and count, only valid if type_status is TYPEART_OK.
+ *  - layout: Layout of the containing type, if it is a struct. Otherwise, layout.num_members is 0.
+ *
+ * \return A status code:
+ *  - TYPEART_OK: The containing type was resolved, see type_status for the innermost type.
+ *  - TYPEART_UNKNOWN_ADDRESS: The given address is either not allocated, or was not correctly recorded by the runtime.
+ *  - TYPEART_ERROR: result is NULL.
+ */
+typeart_status typeart_query_full(const void* addr, typeart_query_result* result);
+
 /**
  * Determines the subtype at the given offset w.r.t. a base address and a corresponding containing type.
  * Note that if the subtype is itself a struct, you may have to call this function again.
@@ -233,6 +283,50 @@ typeart_status typeart_resolve_type_addr(const void* addr, typeart_struct_layout
  */
 typeart_status typeart_resolve_type_id(int type_id, typeart_struct_layout* struct_layout);
 
+typedef struct typeart_type_signature_t {  // NOLINT
+  int type_id;
+  const typeart_signature_entry* entries;
+  size_t num_entries;
+  uint64_t hash;
+} typeart_type_signature;
+
+/**
+ * Given a type ID, this function provides the primitive type signature of one element of the type (built on the first
+ * query of a type). The signature is the sequence of built-in type runs (type, count, byte offset) of the flattened
+ * type, including explicit padding runs (TYPEART_UNKNOWN_TYPE, count in bytes). Runs of the same type at contiguous
+ * offsets are merged, hence, types with equal layout have equal signatures, independent of their struct nesting.
+ * Arrays of structs with several runs are not flattened, but a repeat run (TYPEART_SIGNATURE_REPEAT) of the runs of one
+ * element, see typeart_signature_entry.
+ *
+ * Code example:
+ * {
+ *   struct DataStruct { int a; double b[2]; double c; char d; }; // sizeof(DataStruct) == 40 byte
+ *   typeart_get_type_signature(type_id, &signature);
+ *   -> entries: {TYPEART_INT32, 1, 0}, {TYPEART_UNKNOWN_TYPE, 4, 4}, {TYPEART_DOUBLE, 3, 8}, {TYPEART_INT8, 1, 32},
+ *               {TYPEART_UNKNOWN_TYPE, 7, 33}
+ * }
+ *
+ * A typemap (e.g., of an MPI datatype) is compatible, if its signature (built the same way) has the same hash, which
+ * may be verified by comparing the entries.
+ *
+ * \param[in] type_id The type ID.
+ * \param[out] signature The signature, the entries are owned by the runtime.
+ *
+ * \return One of the following status codes:
+ *  - TYPEART_OK: Success.
+ *  - TYPEART_INVALID_ID: ID is not valid, or the signature of a member struct is unknown.
+ */
+typeart_status typeart_get_type_signature(int type_id, typeart_type_signature* signature);
+
+/**
+ * Computes the hash of a signature, consistent with the hash of typeart_get_type_signature.
+ *
+ * \param[in] entries The signature entries.
+ * \param[in] num_entries Number of entries.
+ * \return The hash value.
+ */
+uint64_t typeart_get_signature_hash(const typeart_signature_entry* entries, size_t num_entries);
+
 /**
  * Returns the name of the type corresponding to the given type ID.
  * This can be used for debugging and error messages.
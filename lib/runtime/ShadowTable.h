@@ -0,0 +1,163 @@
+// TypeART library
+//
+// Copyright (c) 2017-2022 TypeART Authors
+// Distributed under the BSD 3-Clause license.
+// (See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/BSD-3-Clause)
+//
+// Project home: https://github.com/tudasc/TypeART
+//
+// SPDX-License-Identifier: BSD-3-Clause
+//
+
+#ifndef TYPEART_SHADOWTABLE_H
+#define TYPEART_SHADOWTABLE_H
+
+#include "RuntimeData.h"
+
+#include <sys/mman.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace typeart {
+
+#ifndef TYPEART_SHADOW_GRANULE_BITS
+#define TYPEART_SHADOW_GRANULE_BITS 12
+#endif
+
+struct ShadowSlot {
+  MemAddr base{nullptr};
+  RuntimeT::MappedType info{};
+};
+
+/**
+ * Sparse, two-level page directory mapping each granule (2^GranuleBits bytes) of the (48 bit) user address space to
+ * at most one allocation. Directory and leaves are mmap-ed without reserving swap; memory is committed by the OS on
+ * first touch, and leaves are only mapped when a granule inside them is written.
+ * Not thread-safe, the owner synchronizes access.
+ */
+template <unsigned GranuleBits = TYPEART_SHADOW_GRANULE_BITS, unsigned LeafBits = 16>
+class ShadowTable final {
+ public:
+  static constexpr unsigned AddressBits{48};
+  static constexpr uintptr_t GranuleSize{uintptr_t{1} << GranuleBits};
+  static constexpr uintptr_t NumGranules{uintptr_t{1} << (AddressBits - GranuleBits)};
+  static constexpr size_t LeafSlots{size_t{1} << LeafBits};
+  static constexpr size_t DirectorySize{NumGranules >> LeafBits};
+
+ private:
+  ShadowSlot** directory_{nullptr};
+
+  template <typename T>
+  [[nodiscard]] static T* map_zeroed(size_t count) {
+    void* memory =
+        mmap(nullptr, count * sizeof(T), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (memory == MAP_FAILED) {
+      return nullptr;
+    }
+    return static_cast<T*>(memory);
+  }
+
+  [[nodiscard]] ShadowSlot* leaf(uintptr_t granule) const {
+    return directory_ != nullptr ? directory_[granule >> LeafBits] : nullptr;
+  }
+
+  [[nodiscard]] ShadowSlot* leaf_or_create(uintptr_t granule) {
+    if (directory_ == nullptr) {
+      directory_ = map_zeroed<ShadowSlot*>(DirectorySize);
+      if (directory_ == nullptr) {
+        return nullptr;
+      }
+    }
+    auto& entry = directory_[granule >> LeafBits];
+    if (entry == nullptr) {
+      entry = map_zeroed<ShadowSlot>(LeafSlots);
+    }
+    return entry;
+  }
+
+ public:
+  ShadowTable() = default;
+
+  ShadowTable(const ShadowTable&) = delete;
+
+  ShadowTable& operator=(const ShadowTable&) = delete;
+
+  ~ShadowTable() {
+    if (directory_ == nullptr) {
+      return;
+    }
+    for (size_t index = 0; index < DirectorySize; ++index) {
+      if (directory_[index] != nullptr) {
+        munmap(directory_[index], LeafSlots * sizeof(ShadowSlot));
+      }
+    }
+    munmap(directory_, DirectorySize * sizeof(ShadowSlot*));
+  }
+
+  [[nodiscard]] static uintptr_t granule_of(MemAddr addr) {
+    return reinterpret_cast<uintptr_t>(addr) >> GranuleBits;
+  }
+
+  /**
+   * Index of the first granule starting at or after addr.
+   */
+  [[nodiscard]] static uintptr_t first_granule_of(MemAddr addr) {
+    return (reinterpret_cast<uintptr_t>(addr) + GranuleSize - 1) >> GranuleBits;
+  }
+
+  [[nodiscard]] static bool in_range(uintptr_t granule) {
+    return granule < NumGranules;
+  }
+
+  [[nodiscard]] const ShadowSlot* lookup(MemAddr addr) const {
+    return lookup_granule(granule_of(addr));
+  }
+
+  [[nodiscard]] const ShadowSlot* lookup_granule(uintptr_t granule) const {
+    if (!in_range(granule)) {
+      return nullptr;
+    }
+    const ShadowSlot* slots = leaf(granule);
+    if (slots == nullptr) {
+      return nullptr;
+    }
+    const ShadowSlot* slot = &slots[granule & (LeafSlots - 1)];
+    return slot->base != nullptr ? slot : nullptr;
+  }
+
+  /**
+   * Assigns all granules in [first, last) to the allocation at base.
+   */
+  void assign(uintptr_t first, uintptr_t last, MemAddr base, const RuntimeT::MappedType& info) {
+    for (uintptr_t granule = first; granule < last && in_range(granule); ++granule) {
+      ShadowSlot* slots = leaf_or_create(granule);
+      if (slots == nullptr) {
+        return;
+      }
+      slots[granule & (LeafSlots - 1)] = ShadowSlot{base, info};
+    }
+  }
+
+  /**
+   * Clears consecutive granules, starting at first, as long as they are assigned to the allocation at base.
+   */
+  void clear_from(uintptr_t first, MemAddr base) {
+    for (uintptr_t granule = first; in_range(granule); ++granule) {
+      ShadowSlot* slots = leaf(granule);
+      if (slots == nullptr) {
+        return;
+      }
+      auto& slot = slots[granule & (LeafSlots - 1)];
+      if (slot.base != base) {
+        return;
+      }
+      slot = ShadowSlot{};
+    }
+  }
+};
+
+}  // namespace typeart
+
+#endif  // TYPEART_SHADOWTABLE_H
@@ -0,0 +1,181 @@
+// TypeART library
+//
+// Copyright (c) 2017-2022 TypeART Authors
+// Distributed under the BSD 3-Clause license.
+// (See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/BSD-3-Clause)
+//
+// Project home: https://github.com/tudasc/TypeART
+//
+// SPDX-License-Identifier: BSD-3-Clause
+//
+
+#ifndef TYPEART_STACKTRACKING_H
+#define TYPEART_STACKTRACKING_H
+
+#include "AllocMapWrapper.h"
+#include "RuntimeData.h"
+
+#include "llvm/ADT/Optional.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+namespace typeart {
+
+namespace detail {
+struct NoMutex final {
+  void lock() {
+  }
+  void unlock() {
+  }
+  void lock_shared() {
+  }
+  void unlock_shared() {
+  }
+};
+
+#ifdef TYPEART_DISABLE_THREAD_SAFETY
+using StackMutex         = NoMutex;
+using StackRegistryMutex = NoMutex;
+#else
+using StackMutex         = std::mutex;
+using StackRegistryMutex = std::shared_mutex;
+#endif
+
+inline llvm::Optional<RuntimeT::MapEntry> closest_base(const llvm::Optional<RuntimeT::MapEntry>& lhs,
+                                                        const llvm::Optional<RuntimeT::MapEntry>& rhs) {
+  if (!lhs || (rhs && rhs->first > lhs->first)) {
+    return rhs;
+  }
+  return lhs;
+}
+}  // namespace detail
+
+/**
+ * Stack allocations of a single thread, in frame (registration) order.
+ * Only the owning thread modifies the stack, it can query its own entries without synchronization. The (per-thread,
+ * hence uncontended) mutex only serializes the owner's modifications with lookups of other threads, see StackRegistry.
+ */
+class ThreadStack final {
+  RuntimeT::PointerMapBaseT vars_;
+  RuntimeT::Stack order_;
+  mutable detail::StackMutex foreign_m_;
+  // Address bounds of all allocations ever registered, grow monotonically:
+  std::atomic<uintptr_t> lower_{UINTPTR_MAX};
+  std::atomic<uintptr_t> upper_{0};
+
+  void extend_bounds(MemAddr addr, size_t extent_bytes) {
+    const auto begin = reinterpret_cast<uintptr_t>(addr);
+    const auto end   = begin + extent_bytes;
+    if (begin < lower_.load(std::memory_order_relaxed)) {
+      lower_.store(begin, std::memory_order_relaxed);
+    }
+    if (end > upper_.load(std::memory_order_relaxed)) {
+      upper_.store(end, std::memory_order_relaxed);
+    }
+  }
+
+  [[nodiscard]] bool in_bounds(MemAddr addr) const {
+    const auto address = reinterpret_cast<uintptr_t>(addr);
+    return lower_.load(std::memory_order_relaxed) <= address && address <= upper_.load(std::memory_order_relaxed);
+  }
+
+ public:
+  ThreadStack() {
+    order_.reserve(RuntimeT::StackReserve);
+  }
+
+  ThreadStack(const ThreadStack&) = delete;
+
+  ThreadStack& operator=(const ThreadStack&) = delete;
+
+  [[nodiscard]] size_t size() const {
+    return order_.size();
+  }
+
+  [[nodiscard]] bool put(MemAddr addr, const RuntimeT::MappedType& entry, size_t extent_bytes) {
+    std::lock_guard<detail::StackMutex> guard(foreign_m_);
+    const bool overridden = mixin::MapOp::put(&vars_, addr, entry).overridden;
+    order_.push_back(addr);
+    extend_bounds(addr, extent_bytes);
+    return overridden;
+  }
+
+  /**
+   * Removes the last count allocations, the callback is invoked for each in registration order.
+   */
+  template <typename Callback>
+  void pop(size_t count, Callback&& log) {
+    count            = std::min(count, order_.size());
+    const auto cend  = order_.cend();
+    const auto start = cend - count;
+    {
+      std::lock_guard<detail::StackMutex> guard(foreign_m_);
+      mixin::MapOp::bulk_op<mixin::BulkOperation::remove>(&vars_, start, cend, std::forward<Callback>(log));
+    }
+    order_.erase(start, cend);
+  }
+
+  /**
+   * Lookup by the owning thread.
+   */
+  [[nodiscard]] llvm::Optional<RuntimeT::MapEntry> find(MemAddr addr) const {
+    return mixin::MapOp::find(&vars_, addr);
+  }
+
+  /**
+   * Lookup by any other thread.
+   */
+  [[nodiscard]] llvm::Optional<RuntimeT::MapEntry> find_foreign(MemAddr addr) const {
+    if (!in_bounds(addr)) {
+      return llvm::None;
+    }
+    std::lock_guard<detail::StackMutex> guard(foreign_m_);
+    return mixin::MapOp::find(&vars_, addr);
+  }
+};
+
+/**
+ * Registry of all live thread stacks, lets threads resolve addresses on the stack of another thread.
+ */
+class StackRegistry final {
+  std::vector<const ThreadStack*> stacks_;
+  mutable detail::StackRegistryMutex registry_m_;
+
+ public:
+  void add(const ThreadStack* stack) {
+    std::lock_guard<detail::StackRegistryMutex> guard(registry_m_);
+    stacks_.push_back(stack);
+  }
+
+  void erase(const ThreadStack* stack) {
+    std::lock_guard<detail::StackRegistryMutex> guard(registry_m_);
+    stacks_.erase(std::remove(stacks_.begin(), stacks_.end(), stack), stacks_.end());
+  }
+
+  [[nodiscard]] llvm::Optional<RuntimeT::MapEntry> find(MemAddr addr, const ThreadStack* self) const {
+    std::shared_lock<detail::StackRegistryMutex> guard(registry_m_);
+    llvm::Optional<RuntimeT::MapEntry> result;
+    for (const auto* stack : stacks_) {
+      if (stack == self) {
+        continue;
+      }
+      auto candidate = stack->find_foreign(addr);
+      if (candidate && (!result || candidate->first > result->first)) {
+        result.emplace(*candidate);
+      }
+    }
+    return result;
+  }
+};
+
+}  // namespace typeart
+
+#endif  // TYPEART_STACKTRACKING_H
@@ -0,0 +1,119 @@
+// TypeART library
+//
+// Copyright (c) 2017-2022 TypeART Authors
+// Distributed under the BSD 3-Clause license.
+// (See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/BSD-3-Clause)
+//
+// Project home: https://github.com/tudasc/TypeART
+//
+// SPDX-License-Identifier: BSD-3-Clause
+//
+
+#ifndef TYPEART_TRACEFORMAT_H
+#define TYPEART_TRACEFORMAT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace typeart::trace {
+
+/**
+ * Binary event trace (version 1), native byte order: FileHeader | Record[...]
+ * Records of a thread are in order, records of different threads are interleaved in blocks (sort by timestamp).
+ */
+constexpr std::array<char, 8> Magic{'T', 'Y', 'P', 'E', 'A', 'R', 'T', 'E'};
+constexpr uint32_t Version{1};
+constexpr uint32_t ByteOrderMark{0x01020304};
+
+enum class EventKind : uint8_t {
+  alloc_heap = 1,
+  alloc_stack,
+  alloc_global,
+  free_heap,
+  free_stack,
+  leave_scope,
+  query,
+  dropped,  // count: records lost to a full buffer (of the thread) before this record
+  clock,    // timestamp: ticks, count: nanoseconds since the start of the trace (written with each flush)
+};
+
+struct FileHeader {
+  std::array<char, 8> magic;
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t record_size;
+  uint32_t reserved;
+};
+
+/**
+ * A single event, the timestamp is in clock ticks (EventKind::clock records relate ticks to nanoseconds). The status is
+ * the AllocState/FreeState of (de-)allocations, and the typeart_status of queries. The thread index is the index of
+ * the buffer of a thread, which is taken over by a thread started after another one exited (i.e., records of the same
+ * index are in order, and the number of indices is the peak number of threads).
+ */
+struct Record {
+  uint64_t timestamp;
+  uint64_t address;
+  uint64_t count;
+  uint64_t site;
+  int32_t type_id;
+  uint16_t thread;
+  EventKind kind;
+  uint8_t status;
+};
+
+static_assert(std::is_trivially_copyable_v<FileHeader> && std::is_trivially_copyable_v<Record>);
+static_assert(sizeof(Record) == 40, "Trace records are written as is");
+
+inline const char* kind_name(EventKind kind) {
+  switch (kind) {
+    case EventKind::alloc_heap:
+      return "alloc_heap";
+    case EventKind::alloc_stack:
+      return "alloc_stack";
+    case EventKind::alloc_global:
+      return "alloc_global";
+    case EventKind::free_heap:
+      return "free_heap";
+    case EventKind::free_stack:
+      return "free_stack";
+    case EventKind::leave_scope:
+      return "leave_scope";
+    case EventKind::query:
+      return "query";
+    case EventKind::dropped:
+      return "dropped";
+    case EventKind::clock:
+      return "clock";
+  }
+  return "unknown";
+}
+
+/**
+ * Reads the records of a trace file image, a trailing partial record (of an aborted run) is ignored.
+ * @return false, if the header does not match this build (magic, version, byte order or record size).
+ */
+inline bool read_records(const char* data, size_t size, std::vector<Record>& records) {
+  FileHeader header{};
+  if (size < sizeof(header)) {
+    return false;
+  }
+  std::memcpy(&header, data, sizeof(header));
+  if (header.magic != Magic || header.version != Version || header.byte_order != ByteOrderMark ||
+      header.record_size != sizeof(Record)) {
+    return false;
+  }
+  const size_t num_records = (size - sizeof(header)) / sizeof(Record);
+  records.resize(num_records);
+  std::memcpy(records.data(), data + sizeof(header), num_records * sizeof(Record));
+  return true;
+}
+
+}  // namespace typeart::trace
+
+#endif  // TYPEART_TRACEFORMAT_H
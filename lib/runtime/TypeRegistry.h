@@ -0,0 +1,108 @@
+// TypeART library
+//
+// Copyright (c) 2017-2022 TypeART Authors
+// Distributed under the BSD 3-Clause license.
+// (See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/BSD-3-Clause)
+//
+// Project home: https://github.com/tudasc/TypeART
+//
+// SPDX-License-Identifier: BSD-3-Clause
+//
+
+#ifndef TYPEART_TYPEREGISTRY_H
+#define TYPEART_TYPEREGISTRY_H
+
+#include "FlatLayout.h"
+#include "TypeDB.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace typeart {
+
+/**
+ * The type database of the runtime, with the flattened layouts of its struct types.
+ * Registered types (e.g., the embedded types of each module constructor) are collected in a pending batch. The first
+ * query afterwards merges the batch into a copy of the current database, which is then published atomically. Hence,
+ * queries never observe a partially merged database, even if types are registered concurrently (e.g., by the
+ * constructor of a dlopen-ed module). Copies share the records, (built) signatures and layouts of the already
+ * published types, only the layouts of the batch are built. Published databases are kept until the runtime is
+ * destroyed, as queries hand out pointers into them (type names, struct layouts).
+ */
+class TypeRegistry final {
+ public:
+  struct Snapshot {
+    TypeDB db;
+    FlatLayouts layouts;
+  };
+
+ private:
+  mutable std::mutex mutex_;
+  mutable std::vector<std::unique_ptr<const Snapshot>> snapshots_;
+  mutable std::atomic<const Snapshot*> current_{nullptr};
+  mutable TypeDB pending_;
+  mutable std::atomic<bool> dirty_{false};
+
+  [[nodiscard]] const Snapshot& current() const {
+    if (dirty_.load(std::memory_order_acquire)) {
+      publish();
+    }
+    return *current_.load(std::memory_order_acquire);
+  }
+
+  void publish() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!dirty_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    auto next = std::make_unique<Snapshot>(*current_.load(std::memory_order_relaxed));
+    // Conflicting types are not added to the batch, see merge:
+    next->db.merge(pending_);
+    next->layouts.add(next->db, pending_.getStructIDs());
+    pending_.clear();
+
+    current_.store(next.get(), std::memory_order_release);
+    snapshots_.push_back(std::move(next));
+    dirty_.store(false, std::memory_order_release);
+  }
+
+ public:
+  TypeRegistry() {
+    snapshots_.push_back(std::make_unique<const Snapshot>());
+    current_.store(snapshots_.back().get(), std::memory_order_release);
+  }
+
+  TypeRegistry(const TypeRegistry&) = delete;
+  TypeRegistry& operator=(const TypeRegistry&) = delete;
+
+  [[nodiscard]] const TypeDB& db() const {
+    return current().db;
+  }
+
+  [[nodiscard]] const FlatLayouts& layouts() const {
+    return current().layouts;
+  }
+
+  /**
+   * Adds the struct types of types to the pending batch (see TypeDB::mergeBatch), published with the next query.
+   * @return The conflicting type IDs.
+   */
+  std::vector<int> merge(const TypeDB& types, size_t* registered) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t previous_size = pending_.getNumStructs();
+    const auto conflicts       = pending_.mergeBatch(types, current_.load(std::memory_order_relaxed)->db);
+    *registered                = pending_.getNumStructs() - previous_size;
+    if (*registered > 0) {
+      dirty_.store(true, std::memory_order_release);
+    }
+    return conflicts;
+  }
+};
+
+}  // namespace typeart
+
+#endif  // TYPEART_TYPEREGISTRY_H
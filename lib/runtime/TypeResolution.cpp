@@ -13,6 +13,7 @@
 #include "TypeResolution.h"
 
 #include "AllocationTracking.h"
+#include "CallSiteTable.h"
 #include "Runtime.h"
 #include "RuntimeData.h"
 #include "RuntimeInterface.h"
@@ -67,7 +68,8 @@ inline size_t get_member_index_at(const typeart_struct_layout& structInfo, size_
 
 }  // namespace detail
 
-TypeResolution::TypeResolution(const TypeDB& type_db, Recorder& recorder) : typeDB{type_db}, recorder{recorder} {
+TypeResolution::TypeResolution(const TypeRegistry& type_registry, LazyTypeLoader& type_loader, Recorder& recorder)
+    : types{type_registry}, typeLoader{type_loader}, recorder{recorder} {
 }
 
 TypeResolution::TypeArtStatus TypeResolution::getSubTypeInfo(const void* baseAddr, size_t offset,
@@ -88,13 +90,13 @@ TypeResolution::TypeArtStatus TypeResolution::getSubTypeInfo(const void* baseAdd
   const size_t baseOffset  = containerInfo.offsets[memberIndex];
 
   const size_t internalOffset   = offset - baseOffset;
-  const size_t typeSize         = typeDB.getTypeSize(memberType);
+  const size_t typeSize         = types.db().getTypeSize(memberType);
   const size_t offsetInTypeSize = internalOffset / typeSize;
   const size_t newOffset        = internalOffset % typeSize;
 
   // If newOffset != 0, the subtype cannot be atomic, i.e. must be a struct
   if (newOffset != 0) {
-    if (typeDB.isReservedType(memberType)) {
+    if (types.db().isReservedType(memberType)) {
       return TYPEART_BAD_ALIGNMENT;
     }
   }
@@ -166,6 +168,44 @@ TypeResolution::TypeArtStatus TypeResolution::getTypeInfoInternal(const void* ba
   return TYPEART_OK;
 }
 
+TypeResolution::TypeArtStatus TypeResolution::getTypeInfoFlat(const void* baseAddr, size_t offset,
+                                                              const FlatLayout& layout, int* type,
+                                                              size_t* count) const {
+  const FlatLayout* current = &layout;
+  while (true) {
+    const auto* segment = current->find(offset);
+    if (segment == nullptr) {
+      // Address points to padding
+      return TYPEART_BAD_ALIGNMENT;
+    }
+
+    const size_t internal_offset = offset - segment->begin;
+    const size_t element         = internal_offset / segment->stride;
+    offset                       = internal_offset % segment->stride;
+
+    if (offset == 0) {
+      *type  = element == 0 ? segment->anchor_type_id : segment->type_id;
+      *count = element == 0 ? segment->anchor_count : segment->count - element;
+      return TYPEART_OK;
+    }
+    if (!segment->nested) {
+      // Address points to the middle of a builtin type
+      return TYPEART_BAD_ALIGNMENT;
+    }
+    baseAddr = detail::add_byte_offset(baseAddr, segment->begin + element * segment->stride);
+
+    current = types.layouts().lookup(segment->type_id);
+    if (current == nullptr) {
+      const StructTypeInfo* structInfo{nullptr};
+      const auto status_struct_info = getStructInfo(segment->type_id, &structInfo);
+      if (status_struct_info != TYPEART_OK) {
+        return status_struct_info;
+      }
+      return getTypeInfoInternal(baseAddr, offset, *structInfo, type, count);
+    }
+  }
+}
+
 TypeResolution::TypeArtStatus TypeResolution::getTypeInfo(const void* addr, const void* basePtr,
                                                           const PointerInfo& ptrInfo, int* type, size_t* count) const {
   const int containing_type = ptrInfo.typeId;
@@ -181,6 +221,13 @@ TypeResolution::TypeArtStatus TypeResolution::getTypeInfo(const void* addr, cons
     return status;
   }
 
+  return getInnermostTypeInfo(addr, containing_type, containing_type_count, internal_byte_offset, type, count);
+}
+
+TypeResolution::TypeArtStatus TypeResolution::getInnermostTypeInfo(const void* addr, int containing_type,
+                                                                   size_t containing_type_count,
+                                                                   size_t internal_byte_offset, int* type,
+                                                                   size_t* count) const {
   // Check for exact address match
   if (internal_byte_offset == 0) {
     *type  = containing_type;
@@ -188,15 +235,19 @@ TypeResolution::TypeArtStatus TypeResolution::getTypeInfo(const void* addr, cons
     return TYPEART_OK;
   }
 
-  if (typeDB.isBuiltinType(containing_type)) {
+  if (types.db().isBuiltinType(containing_type)) {
     // Address points to the middle of a builtin type
     return TYPEART_BAD_ALIGNMENT;
   }
 
+  const void* containingTypeAddr = detail::add_byte_offset(addr, -std::ptrdiff_t(internal_byte_offset));
+  if (const auto* layout = types.layouts().lookup(containing_type); layout != nullptr) {
+    return getTypeInfoFlat(containingTypeAddr, internal_byte_offset, *layout, type, count);
+  }
+
   // Resolve struct recursively
-  const auto* structInfo = typeDB.getStructInfo(containing_type);
+  const auto* structInfo = types.db().getStructInfo(containing_type);
   if (structInfo != nullptr) {
-    const void* containingTypeAddr = detail::add_byte_offset(addr, -std::ptrdiff_t(internal_byte_offset));
     return getTypeInfoInternal(containingTypeAddr, internal_byte_offset, *structInfo, type, count);
   }
 
@@ -207,7 +258,7 @@ TypeResolution::TypeArtStatus TypeResolution::getContainingTypeInfo(const void*
                                                                     const PointerInfo& ptrInfo, size_t* count,
                                                                     size_t* offset) const {
   const auto& basePtrInfo = ptrInfo;
-  size_t typeSize         = typeDB.getTypeSize(basePtrInfo.typeId);
+  size_t typeSize         = types.db().getTypeSize(basePtrInfo.typeId);
 
   // Check for exact match -> no further checks and offsets calculations needed
   if (basePtr == addr) {
@@ -248,12 +299,13 @@ TypeResolution::TypeArtStatus TypeResolution::getContainingTypeInfo(const void*
 }
 
 TypeResolution::TypeArtStatus TypeResolution::getStructInfo(int type_id, const StructTypeInfo** structInfo) const {
+  typeLoader.require(type_id);
   // Requested ID must correspond to a struct
-  if (!typeDB.isStructType(type_id)) {
+  if (!types.db().isStructType(type_id)) {
     return TYPEART_WRONG_KIND;
   }
 
-  const auto* result = typeDB.getStructInfo(type_id);
+  const auto* result = types.db().getStructInfo(type_id);
 
   if (result != nullptr) {
     *structInfo = result;
@@ -263,19 +315,54 @@ TypeResolution::TypeArtStatus TypeResolution::getStructInfo(int type_id, const S
 }
 
 const TypeDB& TypeResolution::db() const {
-  return typeDB;
+  return types.db();
+}
+
+const TypeDB& TypeResolution::db(int type_id) const {
+  typeLoader.require(type_id);
+  return types.db();
 }
 
 namespace detail {
-inline typeart_status query_type(const void* addr, int* type, size_t* count) {
-  auto alloc = typeart::RuntimeSystem::get().allocTracker.findBaseAlloc(addr);
-  typeart::RuntimeSystem::get().recorder.incUsedInRequest(addr);
+inline typeart_status query_type(const void* addr, int* type, size_t* count, const void* retAddr) {
+  auto& runtime = typeart::RuntimeSystem::get();
+  auto alloc    = runtime.allocTracker.findBaseAlloc(addr);
+  runtime.recorder.incUsedInRequest(addr);
   if (alloc) {
-    return typeart::RuntimeSystem::get().typeResolution.getTypeInfo(addr, alloc->first, alloc->second, type, count);
+    const auto status = runtime.typeResolution.getTypeInfo(addr, alloc->first, alloc->second, type, count);
+    const bool resolved = status == TYPEART_OK;
+    runtime.tracer.record(trace::EventKind::query, addr, resolved ? *type : TYPEART_UNKNOWN_TYPE, resolved ? *count : 0,
+                          retAddr, status);
+    return status;
   }
+  runtime.tracer.record(trace::EventKind::query, addr, TYPEART_UNKNOWN_TYPE, 0, retAddr, TYPEART_UNKNOWN_ADDRESS);
   return TYPEART_UNKNOWN_ADDRESS;
 }
 
+inline typeart_status query_types(const void* const* addrs, size_t num_addrs, int* types, size_t* counts,
+                                  typeart_status* statuses, const void* retAddr) {
+  auto& runtime = typeart::RuntimeSystem::get();
+  std::vector<llvm::Optional<RuntimeT::MapEntry>> allocs(num_addrs);
+  runtime.allocTracker.findBaseAllocs(addrs, num_addrs, allocs.data());
+
+  typeart_status result{TYPEART_OK};
+  for (size_t index = 0; index < num_addrs; ++index) {
+    const auto* addr  = addrs[index];
+    const auto& alloc = allocs[index];
+    runtime.recorder.incUsedInRequest(addr);
+    statuses[index] = alloc ? runtime.typeResolution.getTypeInfo(addr, alloc->first, alloc->second, &types[index],
+                                                                 &counts[index])
+                            : TYPEART_UNKNOWN_ADDRESS;
+    const bool resolved = statuses[index] == TYPEART_OK;
+    runtime.tracer.record(trace::EventKind::query, addr, resolved ? types[index] : TYPEART_UNKNOWN_TYPE,
+                          resolved ? counts[index] : 0, retAddr, statuses[index]);
+    if (result == TYPEART_OK) {
+      result = statuses[index];
+    }
+  }
+  return result;
+}
+
 inline typeart_status query_struct_layout(int type_id, typeart_struct_layout* struct_layout) {
   const typeart::StructTypeInfo* struct_info;
   typeart_status status = typeart::RuntimeSystem::get().typeResolution.getStructInfo(type_id, &struct_info);
@@ -299,6 +386,33 @@ inline typeart_status query_struct_layout(int type_id, typeart_struct_layout* st
   return status;
 }
 
+inline typeart_status query_full(const void* addr, typeart_query_result* result, const void* retAddr) {
+  auto& runtime = typeart::RuntimeSystem::get();
+  auto alloc    = runtime.allocTracker.findBaseAlloc(addr);
+  runtime.recorder.incUsedInRequest(addr);
+  if (!alloc) {
+    runtime.tracer.record(trace::EventKind::query, addr, TYPEART_UNKNOWN_TYPE, 0, retAddr, TYPEART_UNKNOWN_ADDRESS);
+    return TYPEART_UNKNOWN_ADDRESS;
+  }
+
+  const auto& resolution = runtime.typeResolution;
+  const auto status      = resolution.getContainingTypeInfo(addr, alloc->first, alloc->second,
+                                                            &result->containing_count, &result->byte_offset);
+  if (status != TYPEART_OK) {
+    runtime.recorder.incAddrMissing(addr);
+    runtime.tracer.record(trace::EventKind::query, addr, alloc->second.typeId, 0, retAddr, status);
+    return status;
+  }
+  result->base_address       = alloc->first;
+  result->containing_type_id = alloc->second.typeId;
+
+  result->type_status = resolution.getInnermostTypeInfo(addr, result->containing_type_id, result->containing_count,
+                                                        result->byte_offset, &result->type_id, &result->count);
+  query_struct_layout(result->containing_type_id, &result->layout);
+  runtime.tracer.record(trace::EventKind::query, addr, result->type_id, result->count, retAddr, result->type_status);
+  return TYPEART_OK;
+}
+
 char* string2char(std::string_view src) {
   const void* ret_addr       = __builtin_return_address(0);
   const size_t source_length = src.size() + 1;  // +1 for '\0'
@@ -325,19 +439,31 @@ char* string2char(std::string_view src) {
 
 typeart_status typeart_get_type(const void* addr, int* type_id, size_t* count) {
   typeart::RTGuard guard;
-  return typeart::detail::query_type(addr, type_id, count);
+  return typeart::detail::query_type(addr, type_id, count, __builtin_return_address(0));
+}
+
+typeart_status typeart_get_types(const void* const* addrs, size_t num_addrs, int* type_ids, size_t* counts,
+                                 typeart_status* statuses) {
+  typeart::RTGuard guard;
+  if (num_addrs == 0) {
+    return TYPEART_OK;
+  }
+  if (addrs == nullptr || type_ids == nullptr || counts == nullptr || statuses == nullptr) {
+    return TYPEART_ERROR;
+  }
+  return typeart::detail::query_types(addrs, num_addrs, type_ids, counts, statuses, __builtin_return_address(0));
 }
 
 typeart_status typeart_get_type_length(const void* addr, size_t* count) {
   typeart::RTGuard guard;
   int type{0};
-  return typeart::detail::query_type(addr, &type, count);
+  return typeart::detail::query_type(addr, &type, count, __builtin_return_address(0));
 }
 
 typeart_status typeart_get_type_id(const void* addr, int* type_id) {
   typeart::RTGuard guard;
   size_t count{0};
-  return typeart::detail::query_type(addr, type_id, &count);
+  return typeart::detail::query_type(addr, type_id, &count, __builtin_return_address(0));
 }
 
 typeart_status typeart_get_containing_type(const void* addr, int* type_id, size_t* count, const void** base_address,
@@ -354,6 +480,14 @@ typeart_status typeart_get_containing_type(const void* addr, int* type_id, size_
   return TYPEART_UNKNOWN_ADDRESS;
 }
 
+typeart_status typeart_query_full(const void* addr, typeart_query_result* result) {
+  typeart::RTGuard guard;
+  if (result == nullptr) {
+    return TYPEART_ERROR;
+  }
+  return typeart::detail::query_full(addr, result, __builtin_return_address(0));
+}
+
 typeart_status typeart_get_subtype(const void* base_addr, size_t offset, const typeart_struct_layout* container_layout,
                                    int* subtype_id, const void** subtype_base_addr, size_t* subtype_byte_offset,
                                    size_t* subtype_count) {
@@ -367,7 +501,7 @@ typeart_status typeart_resolve_type_addr(const void* addr, typeart_struct_layout
   typeart::RTGuard guard;
   int type_id{0};
   size_t size{0};
-  auto status = typeart::detail::query_type(addr, &type_id, &size);
+  auto status = typeart::detail::query_type(addr, &type_id, &size, __builtin_return_address(0));
   if (status != TYPEART_OK) {
     return status;
   }
@@ -384,7 +518,7 @@ typeart_status typeart_get_return_address(const void* addr, const void** return_
   auto alloc = typeart::RuntimeSystem::get().allocTracker.findBaseAlloc(addr);
 
   if (alloc) {
-    *return_addr = alloc.getValue().second.debug;
+    *return_addr = typeart::return_address_of(alloc.getValue().second);
     return TYPEART_OK;
   }
   *return_addr = nullptr;
@@ -412,42 +546,60 @@ typeart_status_t typeart_get_source_location(const void* addr, char** file, char
   return TYPEART_UNKNOWN_ADDRESS;
 }
 
+typeart_status typeart_get_type_signature(int type_id, typeart_type_signature* signature) {
+  typeart::RTGuard guard;
+  const auto* type_signature = typeart::RuntimeSystem::get().typeResolution.db(type_id).getSignature(type_id);
+  if (type_signature == nullptr) {
+    return TYPEART_INVALID_ID;
+  }
+  signature->type_id     = type_id;
+  signature->entries     = type_signature->entries.data();
+  signature->num_entries = type_signature->entries.size();
+  signature->hash        = type_signature->hash;
+  return TYPEART_OK;
+}
+
+uint64_t typeart_get_signature_hash(const typeart_signature_entry* entries, size_t num_entries) {
+  typeart::RTGuard guard;
+  return typeart::TypeDB::hashSignature(entries, num_entries);
+}
+
 const char* typeart_get_type_name(int type_id) {
   typeart::RTGuard guard;
-  return typeart::RuntimeSystem::get().typeResolution.db().getTypeName(type_id).c_str();
+  return typeart::RuntimeSystem::get().typeResolution.db(type_id).getTypeName(type_id).c_str();
 }
 
 bool typeart_is_vector_type(int type_id) {
   typeart::RTGuard guard;
-  return typeart::RuntimeSystem::get().typeResolution.db().isVectorType(type_id);
+  return typeart::RuntimeSystem::get().typeResolution.db(type_id).isVectorType(type_id);
 }
 
 bool typeart_is_valid_type(int type_id) {
   typeart::RTGuard guard;
-  return typeart::RuntimeSystem::get().typeResolution.db().isValid(type_id);
+  return typeart::RuntimeSystem::get().typeResolution.db(type_id).isValid(type_id);
 }
 
 bool typeart_is_reserved_type(int type_id) {
   typeart::RTGuard guard;
-  return typeart::RuntimeSystem::get().typeResolution.db().isReservedType(type_id);
+  return typeart::RuntimeSystem::get().typeResolution.db(type_id).isReservedType(type_id);
 }
 
 bool typeart_is_builtin_type(int type_id) {
   typeart::RTGuard guard;
-  return typeart::RuntimeSystem::get().typeResolution.db().isBuiltinType(type_id);
+  return typeart::RuntimeSystem::get().typeResolution.db(type_id).isBuiltinType(type_id);
 }
 
 bool typeart_is_struct_type(int type_id) {
   typeart::RTGuard guard;
-  return typeart::RuntimeSystem::get().typeResolution.db().isStructType(type_id);
+  return typeart::RuntimeSystem::get().typeResolution.db(type_id).isStructType(type_id);
 }
 
 bool typeart_is_userdefined_type(int type_id) {
   typeart::RTGuard guard;
-  return typeart::RuntimeSystem::get().typeResolution.db().isUserDefinedType(type_id);
+  return typeart::RuntimeSystem::get().typeResolution.db(type_id).isUserDefinedType(type_id);
 }
 
 size_t typeart_get_type_size(int type_id) {
   typeart::RTGuard guard;
-  return typeart::RuntimeSystem::get().typeResolution.db().getTypeSize(type_id);
+  return typeart::RuntimeSystem::get().typeResolution.db(type_id).getTypeSize(type_id);
 }
@@ -14,9 +14,11 @@
 #define TYPEART_TYPERESOLUTION_H
 
 #include "AccessCounter.h"
+#include "FlatLayout.h"
 #include "RuntimeData.h"
 #include "RuntimeInterface.h"
-#include "TypeDB.h"
+#include "LazyTypeLoader.h"
+#include "TypeRegistry.h"
 #include "TypeInterface.h"
 
 #include <cstddef>
@@ -27,13 +29,14 @@ namespace typeart {
 struct PointerInfo;
 
 class TypeResolution {
-  const TypeDB& typeDB;
+  const TypeRegistry& types;
+  LazyTypeLoader& typeLoader;
   Recorder& recorder;
 
  public:
   using TypeArtStatus = typeart_status;
 
-  TypeResolution(const TypeDB& type_db, Recorder& recorder);
+  TypeResolution(const TypeRegistry& type_registry, LazyTypeLoader& type_loader, Recorder& recorder);
 
   TypeArtStatus getSubTypeInfo(const void* baseAddr, size_t offset, const typeart_struct_layout& containerInfo,
                                int* subType, const void** subTypeBaseAddr, size_t* subTypeOffset,
@@ -42,15 +45,26 @@ class TypeResolution {
   TypeArtStatus getTypeInfoInternal(const void* struct_type_info, size_t offset, const StructTypeInfo& containerInfo,
                                     int* type, size_t* count) const;
 
+  TypeArtStatus getTypeInfoFlat(const void* baseAddr, size_t offset, const FlatLayout& layout, int* type,
+                                size_t* count) const;
+
   TypeArtStatus getTypeInfo(const void* addr, const void* basePtr, const PointerInfo& ptrInfo, int* type,
                             size_t* count) const;
 
+  TypeArtStatus getInnermostTypeInfo(const void* addr, int containing_type, size_t containing_count,
+                                     size_t byte_offset, int* type, size_t* count) const;
+
   TypeArtStatus getContainingTypeInfo(const void* addr, const void* basePtr, const PointerInfo& ptrInfo, size_t* count,
                                       size_t* offset) const;
 
   TypeArtStatus getStructInfo(int type_id, const StructTypeInfo** structInfo) const;
 
   [[nodiscard]] const TypeDB& db() const;
+
+  /**
+   * The type database, with the type file loaded if type_id is a user-defined type.
+   */
+  [[nodiscard]] const TypeDB& db(int type_id) const;
 };
 
 }  // namespace typeart
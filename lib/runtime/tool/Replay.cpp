@@ -0,0 +1,741 @@
+// TypeART library
+//
+// Copyright (c) 2017-2022 TypeART Authors
+// Distributed under the BSD 3-Clause license.
+// (See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/BSD-3-Clause)
+//
+// Project home: https://github.com/tudasc/TypeART
+//
+// SPDX-License-Identifier: BSD-3-Clause
+//
+
+#include "AccessCounter.h"
+#include "AllocMapWrapper.h"
+#include "AllocationTracking.h"
+#include "EventTrace.h"
+#include "LazyTypeLoader.h"
+#include "TraceFormat.h"
+#include "TypeDB.h"
+#include "TypeIO.h"
+#include "TypeInterface.h"
+#include "TypeRegistry.h"
+#include "TypeResolution.h"
+
+#include "llvm/ADT/Optional.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+enum class OutputFormat { text, csv };
+}  // namespace
+
+static cl::OptionCategory replay_category("TypeART allocation replay");
+
+static cl::opt<std::string> cl_trace(cl::Positional, cl::desc("[<trace file>]"), cl::Optional,
+                                     cl::cat(replay_category));
+
+static cl::opt<std::string> cl_types("types", cl::desc("Type file of the user-defined types of the trace"),
+                                     cl::value_desc("file"), cl::cat(replay_category));
+
+static cl::opt<unsigned> cl_threads("threads",
+                                    cl::desc("Number of synthetic threads, or of concurrent copies of the trace"),
+                                    cl::init(1), cl::cat(replay_category));
+
+static cl::list<std::string> cl_backends("backends",
+                                         cl::desc("Pointer map backends to compare, <strategy>[:<container>] as "
+                                                  "TYPEART_MAP_BACKEND (default: all strategies)"),
+                                         cl::CommaSeparated, cl::value_desc("backend,..."), cl::cat(replay_category));
+
+static cl::opt<unsigned> cl_size("size", cl::desc("Synthetic: edge length of the mesh in elements"), cl::init(16),
+                                 cl::cat(replay_category));
+
+static cl::opt<unsigned> cl_iterations("iterations", cl::desc("Synthetic: number of time steps"), cl::init(10),
+                                       cl::cat(replay_category));
+
+static cl::opt<unsigned> cl_regions("regions", cl::desc("Synthetic: number of material regions"), cl::init(11),
+                                    cl::cat(replay_category));
+
+static cl::opt<unsigned> cl_queries("queries", cl::desc("Synthetic: type queries per time step"), cl::init(256),
+                                    cl::cat(replay_category));
+
+static cl::opt<unsigned> cl_seed("seed", cl::desc("Synthetic: random seed"), cl::init(42), cl::cat(replay_category));
+
+static cl::opt<unsigned> cl_sample("sample", cl::desc("Measure the latency of every n-th operation (0: none)"),
+                                   cl::init(16), cl::cat(replay_category));
+
+static cl::opt<OutputFormat> cl_format("format", cl::desc("Output format:"),
+                                       cl::values(clEnumValN(OutputFormat::text, "text", "Tables (default)"),
+                                                  clEnumValN(OutputFormat::csv, "csv", "Comma-separated values")),
+                                       cl::init(OutputFormat::text), cl::cat(replay_category));
+
+namespace {
+using typeart::trace::EventKind;
+using typeart::trace::Record;
+using Clock = std::chrono::steady_clock;
+
+// Replayed threads get disjoint 2^40 byte ranges (synthetic), or disjoint address keys (trace copies), below 2^47:
+constexpr unsigned MaxThreads{127};
+constexpr unsigned AddressKeyShift{40};
+
+enum class Operation : unsigned { alloc = 0, free, leave_scope, query, all };
+constexpr size_t NumOperations{static_cast<size_t>(Operation::all) + 1};
+constexpr std::array<const char*, NumOperations> OperationNames{"alloc", "free", "leave_scope", "query", "all"};
+
+inline Operation operation_of(EventKind kind) {
+  switch (kind) {
+    case EventKind::alloc_heap:
+    case EventKind::alloc_stack:
+    case EventKind::alloc_global:
+      return Operation::alloc;
+    case EventKind::free_heap:
+      return Operation::free;
+    case EventKind::leave_scope:
+      return Operation::leave_scope;
+    default:
+      return Operation::query;
+  }
+}
+
+/**
+ * The events of one replaying thread. Copies of a trace share the events, the address key (XOR-ed into all non-null
+ * addresses) keeps their allocations apart.
+ */
+struct Stream {
+  const std::vector<Record>* events;
+  uint64_t address_key{0};
+};
+
+/**
+ * Synthetic events modelled on the allocations of LULESH (one rank): the domain arrays live for the whole run, each
+ * time step allocates and frees the temporaries of its kernels, and the element loops of some kernels enter a scope
+ * with small stack arrays per element. Type queries resolve random (mostly interior) addresses of live arrays, few
+ * miss.
+ */
+class LuleshGenerator {
+  struct Array {
+    uint64_t address;
+    int type_id;
+    size_t count;
+    uint64_t bytes;
+  };
+
+  struct Kernel {
+    unsigned temporaries;  // heap arrays, allocated on entry
+    unsigned length;       // of a temporary, in elements (times the number of elements of the domain or region)
+    unsigned allocas;      // stack arrays per element (0: no per-element scope)
+    bool per_region;
+  };
+
+  // The kernels of one time step (LagrangeLeapFrog):
+  static constexpr std::array<Kernel, 7> Kernels{{
+      {4, 1, 0, false},  // CalcVolumeForceForElems: sigxx, sigyy, sigzz, determ
+      {3, 8, 4, false},  // IntegrateStressForElems: fx_elem, ...; B, x_local, y_local, z_local
+      {6, 8, 0, false},  // CalcHourglassControlForElems: dvdx, ..., x8n, ...
+      {3, 8, 6, false},  // CalcFBHourglassForceForElems: fx_elem, ...; hourgam, xd1, yd1, zd1, hgfx, hgfy
+      {3, 1, 3, false},  // CalcLagrangeElements (AllocateStrains): dxx, dyy, dzz; B, D, x_local
+      {6, 1, 2, false},  // CalcQForElems (AllocateGradients): delx_xi, ..., delv_zeta; x_local, y_local
+      {14, 1, 0, true},  // EvalEOSForElems: e_old, delvc, p_old, q_old, compression, ...
+  }};
+
+  // Lengths of the stack arrays of an element scope (in doubles):
+  static constexpr std::array<size_t, 6> FrameArrays{24, 8, 8, 8, 3, 1};
+
+  static constexpr uint64_t Alignment{16};
+  // Stack of the thread, grows down, above lie the addresses of missing queries:
+  static constexpr uint64_t StackOffset{uint64_t{1} << 39};
+
+  const typeart::TypeDB& db;
+  std::vector<Record>& events;
+  std::mt19937_64 rng;
+  const uint64_t region_base;
+  uint64_t heap_top;
+  uint64_t stack_top;
+  // Freed blocks by size, re-used as malloc would:
+  std::unordered_map<uint64_t, std::vector<uint64_t>> free_blocks;
+  std::vector<Array> live;
+
+  static uint64_t site(unsigned id) {
+    return 0x401000 + uint64_t{id} * 0x10;
+  }
+
+  void emit(EventKind kind, uint64_t address, int type_id, size_t count, unsigned site_id) {
+    events.push_back(Record{0, address, count, site(site_id), type_id, 0, kind, 0});
+  }
+
+  void heap_alloc(int type_id, size_t count, unsigned site_id) {
+    const uint64_t bytes = (db.getTypeSize(type_id) * count + Alignment - 1) & ~(Alignment - 1);
+    auto& blocks         = free_blocks[bytes];
+    uint64_t address     = heap_top;
+    if (blocks.empty()) {
+      // Leaves room for the chunk header of the allocator:
+      heap_top += bytes + Alignment;
+    } else {
+      address = blocks.back();
+      blocks.pop_back();
+    }
+    emit(EventKind::alloc_heap, address, type_id, count, site_id);
+    live.push_back(Array{address, type_id, count, bytes});
+  }
+
+  void heap_free_last(unsigned site_id) {
+    const auto array = live.back();
+    live.pop_back();
+    emit(EventKind::free_heap, array.address, array.type_id, array.count, site_id);
+    free_blocks[array.bytes].push_back(array.address);
+  }
+
+  void element_scope(unsigned allocas, unsigned site_id) {
+    const uint64_t frame_top = stack_top;
+    for (unsigned index = 0; index < allocas; ++index) {
+      const size_t count = FrameArrays[index % FrameArrays.size()];
+      stack_top -= (count * sizeof(double) + Alignment - 1) & ~(Alignment - 1);
+      emit(EventKind::alloc_stack, stack_top, TYPEART_DOUBLE, count, site_id);
+    }
+    emit(EventKind::leave_scope, 0, TYPEART_UNKNOWN_TYPE, allocas, site_id);
+    stack_top = frame_top;
+  }
+
+  void queries(unsigned count, unsigned site_id) {
+    for (unsigned query = 0; query < count; ++query) {
+      const auto choice = rng() % 16;
+      if (choice == 0 || live.empty()) {
+        emit(EventKind::query, region_base + StackOffset + Alignment * (1 + rng() % 4096), TYPEART_UNKNOWN_TYPE, 0,
+             site_id);
+        continue;
+      }
+      const auto& array    = live[rng() % live.size()];
+      const size_t element = choice == 1 ? 0 : rng() % array.count;
+      emit(EventKind::query, array.address + element * db.getTypeSize(array.type_id), TYPEART_UNKNOWN_TYPE, 0,
+           site_id);
+    }
+  }
+
+  [[nodiscard]] std::vector<size_t> region_sizes(size_t elements, unsigned regions) {
+    std::vector<size_t> weights(std::max(1U, regions));
+    std::generate(weights.begin(), weights.end(), [&]() { return 1 + rng() % 10; });
+    const size_t total = std::accumulate(weights.begin(), weights.end(), size_t{0});
+    std::vector<size_t> sizes;
+    for (const auto weight : weights) {
+      sizes.push_back(std::max<size_t>(1, elements * weight / total));
+    }
+    return sizes;
+  }
+
+ public:
+  LuleshGenerator(const typeart::TypeDB& type_db, std::vector<Record>& sequence, unsigned thread, unsigned seed)
+      : db(type_db),
+        events(sequence),
+        rng(seed + thread),
+        region_base(uint64_t{thread + 1} << AddressKeyShift),
+        heap_top(region_base + Alignment),
+        stack_top(region_base + StackOffset) {
+  }
+
+  void run(unsigned size, unsigned iterations, unsigned regions, unsigned num_queries) {
+    const size_t elements = size_t{size} * size * size;
+    const size_t nodes    = size_t{size + 1} * (size + 1) * (size + 1);
+    const size_t planes   = size_t{size + 1} * (size + 1);
+    unsigned site_id{0};
+
+    // Domain: node-centered, element-centered and connectivity arrays
+    for (unsigned array = 0; array < 13; ++array) {
+      heap_alloc(TYPEART_DOUBLE, nodes, site_id++);
+    }
+    for (unsigned array = 0; array < 24; ++array) {
+      heap_alloc(TYPEART_DOUBLE, elements, site_id++);
+    }
+    heap_alloc(TYPEART_INT32, 8 * elements, site_id++);
+    for (unsigned array = 0; array < 7; ++array) {
+      heap_alloc(TYPEART_INT32, elements, site_id++);
+    }
+    for (unsigned array = 0; array < 3; ++array) {
+      heap_alloc(TYPEART_INT32, planes, site_id++);
+    }
+    const size_t domain_arrays = live.size();
+    const auto regions_elems   = region_sizes(elements, regions);
+
+    const unsigned kernel_sites = site_id;
+    for (unsigned step = 0; step < iterations; ++step) {
+      for (size_t index = 0; index < Kernels.size(); ++index) {
+        const auto& kernel     = Kernels[index];
+        const unsigned site_of = kernel_sites + static_cast<unsigned>(index) * 4;
+        const std::vector<size_t> extents =
+            kernel.per_region ? regions_elems : std::vector<size_t>{elements * kernel.length};
+        for (const auto extent : extents) {
+          for (unsigned temporary = 0; temporary < kernel.temporaries; ++temporary) {
+            heap_alloc(TYPEART_DOUBLE, extent, site_of);
+          }
+          if (kernel.allocas > 0) {
+            for (size_t element = 0; element < elements; ++element) {
+              element_scope(kernel.allocas, site_of + 1);
+            }
+          }
+          queries(num_queries / Kernels.size() + (index == 0 ? num_queries % Kernels.size() : 0), site_of + 2);
+          while (live.size() > domain_arrays) {
+            heap_free_last(site_of + 3);
+          }
+        }
+      }
+    }
+
+    while (!live.empty()) {
+      heap_free_last(site_id);
+    }
+  }
+};
+
+/**
+ * Reads the replayable events of a trace, one sequence per recorded thread. Stack frees are replayed by their scope.
+ */
+bool load_trace(const std::string& file, std::vector<std::vector<Record>>& sequences) {
+  auto buffer = MemoryBuffer::getFile(file, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+  if (!buffer) {
+    errs() << "Failed to read trace file " << file << ": " << buffer.getError().message() << "\n";
+    return false;
+  }
+  std::vector<Record> records;
+  const StringRef data = buffer.get()->getBuffer();
+  if (!typeart::trace::read_records(data.data(), data.size(), records)) {
+    errs() << "Unsupported trace file (magic, version, byte order or record size): " << file << "\n";
+    return false;
+  }
+
+  uint64_t lost{0};
+  for (const auto& record : records) {
+    switch (record.kind) {
+      case EventKind::alloc_heap:
+      case EventKind::alloc_stack:
+      case EventKind::alloc_global:
+      case EventKind::free_heap:
+      case EventKind::leave_scope:
+      case EventKind::query:
+        if (record.thread >= sequences.size()) {
+          sequences.resize(record.thread + size_t{1});
+        }
+        sequences[record.thread].push_back(record);
+        break;
+      case EventKind::dropped:
+        lost += record.count;
+        break;
+      default:
+        break;
+    }
+  }
+  sequences.erase(std::remove_if(sequences.begin(), sequences.end(), [](const auto& events) { return events.empty(); }),
+                  sequences.end());
+  if (lost > 0) {
+    errs() << "Warning: The trace lost " << lost << " events, replayed frees and scopes may miss their allocation\n";
+  }
+  return true;
+}
+
+/**
+ * The runtime state of one replay, set up as by the runtime system, with the types loaded up-front.
+ */
+class Replayer {
+  typeart::TypeRegistry types;
+  typeart::LazyTypeLoader loader;
+  typeart::Recorder recorder{};
+  typeart::EventTracer tracer{};
+  typeart::TypeResolution resolution;
+  typeart::AllocationTracker tracker;
+
+  static inline const void* address_of(uint64_t address, uint64_t key) {
+    return reinterpret_cast<const void*>(address == 0 ? address : address ^ key);
+  }
+
+  inline void query(const void* addr) {
+    // As typeart_get_type:
+    int type_id{TYPEART_UNKNOWN_TYPE};
+    size_t count{0};
+    const auto base = tracker.findBaseAlloc(addr);
+    recorder.incUsedInRequest(addr);
+    if (base) {
+      resolution.getTypeInfo(addr, base->first, base->second, &type_id, &count);
+    }
+  }
+
+ public:
+  explicit Replayer(const typeart::TypeDB& type_db)
+      : loader([] {}), resolution(types, loader, recorder), tracker(types, loader, recorder, tracer) {
+    size_t registered{0};
+    types.merge(type_db, &registered);
+    loader.requireAll();
+  }
+
+  inline void execute(const Record& record, uint64_t key) {
+    const auto* addr = address_of(record.address, key);
+    const auto* site = reinterpret_cast<const void*>(record.site);
+    switch (record.kind) {
+      case EventKind::alloc_heap:
+        tracker.onAlloc(addr, record.type_id, record.count, site);
+        break;
+      case EventKind::alloc_stack:
+        tracker.onAllocStack(addr, record.type_id, record.count, site);
+        break;
+      case EventKind::alloc_global:
+        tracker.onAllocGlobal(addr, record.type_id, record.count, site);
+        break;
+      case EventKind::free_heap:
+        tracker.onFreeHeap(addr, site);
+        break;
+      case EventKind::leave_scope:
+        tracker.onLeaveScope(static_cast<int>(record.count), site);
+        break;
+      case EventKind::query:
+        query(addr);
+        break;
+      default:
+        break;
+    }
+  }
+
+  void flush() {
+    tracker.flush();
+  }
+};
+
+struct Latency {
+  uint64_t samples{0};
+  std::array<double, 5> percentiles{};  // p50, p90, p99, p99.9, max
+};
+
+constexpr std::array<double, 5> Percentiles{0.5, 0.9, 0.99, 0.999, 1.0};
+
+/**
+ * Result of one backend, passed from the replaying (child) process as is.
+ */
+struct RunResult {
+  uint64_t events{0};
+  double seconds{0};
+  long peak_rss_kib{0};
+  long rss_growth_kib{0};
+  std::array<Latency, NumOperations> latency{};
+};
+
+long peak_rss_kib() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+uint64_t timer_overhead_ns() {
+  auto overhead = Clock::duration::max();
+  for (unsigned round = 0; round < 1000; ++round) {
+    const auto start = Clock::now();
+    overhead         = std::min(overhead, Clock::now() - start);
+  }
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(overhead).count();
+}
+
+Latency latency_of(std::vector<uint64_t>& samples) {
+  Latency latency;
+  latency.samples = samples.size();
+  if (samples.empty()) {
+    return latency;
+  }
+  std::sort(samples.begin(), samples.end());
+  for (size_t index = 0; index < Percentiles.size(); ++index) {
+    const auto rank            = static_cast<size_t>(Percentiles[index] * static_cast<double>(samples.size() - 1));
+    latency.percentiles[index] = static_cast<double>(samples[rank]);
+  }
+  return latency;
+}
+
+RunResult replay(const typeart::TypeDB& db, const std::vector<Stream>& streams, unsigned sample) {
+  using Samples = std::array<std::vector<uint64_t>, NumOperations - 1>;
+  RunResult result;
+  const long rss_start  = peak_rss_kib();
+  const auto overhead   = timer_overhead_ns();
+  const auto to_latency = [overhead](Clock::duration duration) -> uint64_t {
+    const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    return ns > overhead ? ns - overhead : 0;
+  };
+
+  Replayer replayer(db);
+  std::vector<Samples> samples(streams.size());
+  std::atomic<size_t> ready{0};
+  std::atomic<bool> go{false};
+  std::vector<std::thread> threads;
+  // Each stream is replayed by a new thread, i.e., with empty thread-local runtime state (stack, lookup cache):
+  for (size_t index = 0; index < streams.size(); ++index) {
+    threads.emplace_back([&, index]() {
+      const auto& stream = streams[index];
+      auto& own_samples  = samples[index];
+      ready.fetch_add(1);
+      while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      unsigned countdown = sample;
+      for (const auto& record : *stream.events) {
+        if (sample == 0 || --countdown != 0) {
+          replayer.execute(record, stream.address_key);
+          continue;
+        }
+        countdown        = sample;
+        const auto start = Clock::now();
+        replayer.execute(record, stream.address_key);
+        const auto stop = Clock::now();
+        own_samples[static_cast<size_t>(operation_of(record.kind))].push_back(to_latency(stop - start));
+      }
+    });
+  }
+  while (ready.load() < streams.size()) {
+    std::this_thread::yield();
+  }
+  const auto start = Clock::now();
+  go.store(true, std::memory_order_release);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  replayer.flush();
+  const auto stop = Clock::now();
+
+  result.seconds = std::chrono::duration<double>(stop - start).count();
+  for (const auto& stream : streams) {
+    result.events += stream.events->size();
+  }
+  std::vector<uint64_t> all;
+  for (size_t operation = 0; operation + 1 < NumOperations; ++operation) {
+    std::vector<uint64_t> merged;
+    for (auto& thread_samples : samples) {
+      merged.insert(merged.end(), thread_samples[operation].begin(), thread_samples[operation].end());
+    }
+    all.insert(all.end(), merged.begin(), merged.end());
+    result.latency[operation] = latency_of(merged);
+  }
+  result.latency[static_cast<size_t>(Operation::all)] = latency_of(all);
+  result.peak_rss_kib                                 = peak_rss_kib();
+  result.rss_growth_kib                               = result.peak_rss_kib - rss_start;
+  return result;
+}
+
+/**
+ * Runs the replay in a child process, the peak RSS is of this backend only, and a crashing backend is reported.
+ */
+Optional<RunResult> run_isolated(const std::function<RunResult()>& run) {
+  int fds[2];
+  if (pipe(fds) != 0) {
+    return None;
+  }
+  outs().flush();
+  errs().flush();
+  const pid_t pid = fork();
+  if (pid < 0) {
+    close(fds[0]);
+    close(fds[1]);
+    return None;
+  }
+  if (pid == 0) {
+    close(fds[0]);
+    const RunResult result = run();
+    const bool written     = write(fds[1], &result, sizeof(result)) == static_cast<ssize_t>(sizeof(result));
+    close(fds[1]);
+    _exit(written ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+  close(fds[1]);
+  RunResult result;
+  size_t received{0};
+  auto* bytes = reinterpret_cast<char*>(&result);
+  while (received < sizeof(result)) {
+    const ssize_t count = read(fds[0], bytes + received, sizeof(result) - received);
+    if (count <= 0) {
+      break;
+    }
+    received += static_cast<size_t>(count);
+  }
+  close(fds[0]);
+  int status{0};
+  waitpid(pid, &status, 0);
+  if (received != sizeof(result) || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+    return None;
+  }
+  return result;
+}
+
+bool select_backends(size_t num_threads, std::vector<std::string>& backends) {
+#ifdef TYPEART_MAP_BACKEND_SELECTION
+  backends.assign(cl_backends.begin(), cl_backends.end());
+  if (backends.empty()) {
+    for (const auto strategy : typeart::PointerMap::strategies) {
+      if (num_threads == 1 || strategy.substr(0, 6) != "unsafe") {
+        backends.emplace_back(strategy);
+      }
+    }
+  }
+  for (const auto& backend : backends) {
+    if (!typeart::PointerMap::is_valid(backend)) {
+      errs() << "Unknown map backend " << backend << "\n";
+      return false;
+    }
+    if (num_threads > 1 && backend.substr(0, 6) == "unsafe") {
+      errs() << "Map backend " << backend << " is not thread-safe, replay with a single thread\n";
+      return false;
+    }
+  }
+#else
+  if (!cl_backends.empty()) {
+    errs() << "Warning: Built without TYPEART_MAP_BACKEND_SELECTION, replaying the configured backend only\n";
+  }
+  backends = {"configured"};
+#endif
+  return true;
+}
+
+void print_text(const std::vector<std::string>& backends, const std::vector<Optional<RunResult>>& results,
+                size_t num_threads, raw_ostream& out) {
+  out << "Replay with " << num_threads << " thread(s)\n";
+  out << "backend                events       events/s   time [s]   peak RSS [KiB]   RSS growth [KiB]\n";
+  for (size_t index = 0; index < backends.size(); ++index) {
+    const auto& result = results[index];
+    if (!result) {
+      out << left_justify(backends[index], 16) << " failed\n";
+      continue;
+    }
+    const double rate = static_cast<double>(result->events) / result->seconds;
+    out << format("%-16s %12llu %14.0f %10.3f %16ld %18ld\n", backends[index].c_str(),
+                  static_cast<unsigned long long>(result->events), rate, result->seconds, result->peak_rss_kib,
+                  result->rss_growth_kib);
+  }
+  if (cl_sample == 0) {
+    return;
+  }
+  out << "Latency [ns] of 1 in " << cl_sample << " operations, without the timer overhead\n";
+  out << "backend          operation       samples      p50      p90      p99    p99.9        max\n";
+  for (size_t index = 0; index < backends.size(); ++index) {
+    const auto& result = results[index];
+    if (!result) {
+      continue;
+    }
+    for (size_t operation = 0; operation < NumOperations; ++operation) {
+      const auto& latency = result->latency[operation];
+      if (latency.samples == 0) {
+        continue;
+      }
+      const auto& p = latency.percentiles;
+      out << format("%-16s %-12s %10llu %8.0f %8.0f %8.0f %8.0f %10.0f\n", backends[index].c_str(),
+                    OperationNames[operation], static_cast<unsigned long long>(latency.samples), p[0], p[1], p[2],
+                    p[3], p[4]);
+    }
+  }
+}
+
+void print_csv(const std::vector<std::string>& backends, const std::vector<Optional<RunResult>>& results,
+               size_t num_threads, raw_ostream& out) {
+  out << "backend,threads,events,seconds,events_per_second,peak_rss_kib,rss_growth_kib,operation,samples,p50_ns,p90_"
+         "ns,p99_ns,p999_ns,max_ns\n";
+  for (size_t index = 0; index < backends.size(); ++index) {
+    const auto& result = results[index];
+    if (!result) {
+      continue;
+    }
+    for (size_t operation = 0; operation < NumOperations; ++operation) {
+      const auto& latency = result->latency[operation];
+      const auto& p       = latency.percentiles;
+      out << backends[index] << "," << num_threads << "," << result->events << ","
+          << format("%.6f,%.0f", result->seconds, static_cast<double>(result->events) / result->seconds) << ","
+          << result->peak_rss_kib << "," << result->rss_growth_kib << "," << OperationNames[operation] << ","
+          << latency.samples << "," << format("%.0f,%.0f,%.0f,%.0f,%.0f", p[0], p[1], p[2], p[3], p[4]) << "\n";
+    }
+  }
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  cl::HideUnrelatedOptions(replay_category);
+  cl::ParseCommandLineOptions(argc, argv,
+                              "Replays allocation, free, scope and query events against the TypeART runtime, for "
+                              "each map backend.\nEvents are read from a trace (TYPEART_TRACE_FILE), or generated "
+                              "(modelled on LULESH) without a trace.\n");
+
+  if (cl_threads == 0 || cl_threads > MaxThreads) {
+    errs() << "Number of threads must be in [1, " << MaxThreads << "]\n";
+    return EXIT_FAILURE;
+  }
+
+  typeart::TypeDB type_db;
+  if (!cl_types.empty()) {
+    auto loaded = typeart::io::load(&type_db, cl_types);
+    if (!loaded || !loaded.get()) {
+      errs() << "Failed to load type file " << cl_types << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::vector<std::vector<Record>> sequences;
+  std::vector<Stream> streams;
+  if (!cl_trace.empty()) {
+    if (!load_trace(cl_trace, sequences)) {
+      return EXIT_FAILURE;
+    }
+    for (unsigned copy = 0; copy < cl_threads; ++copy) {
+      for (const auto& events : sequences) {
+        streams.push_back(Stream{&events, uint64_t{copy} << AddressKeyShift});
+      }
+    }
+  } else {
+    sequences.resize(cl_threads);
+    for (unsigned thread = 0; thread < cl_threads; ++thread) {
+      LuleshGenerator{type_db, sequences[thread], thread, cl_seed}.run(cl_size, cl_iterations, cl_regions,
+                                                                       cl_queries);
+      streams.push_back(Stream{&sequences[thread], 0});
+    }
+  }
+
+#ifdef TYPEART_DISABLE_THREAD_SAFETY
+  if (streams.size() > 1) {
+    errs() << "Built with TYPEART_DISABLE_THREAD_SAFETY, replay with a single thread\n";
+    return EXIT_FAILURE;
+  }
+#endif
+
+  std::vector<std::string> backends;
+  if (!select_backends(streams.size(), backends)) {
+    return EXIT_FAILURE;
+  }
+
+  std::vector<Optional<RunResult>> results;
+  for (const auto& backend : backends) {
+    results.push_back(run_isolated([&]() {
+#ifdef TYPEART_MAP_BACKEND_SELECTION
+      setenv("TYPEART_MAP_BACKEND", backend.c_str(), 1);
+#endif
+      return replay(type_db, streams, cl_sample);
+    }));
+    if (!results.back()) {
+      errs() << "Replay with map backend " << backend << " failed\n";
+    }
+  }
+
+  if (cl_format == OutputFormat::csv) {
+    print_csv(backends, results, streams.size(), outs());
+  } else {
+    print_text(backends, results, streams.size(), outs());
+  }
+  return std::all_of(results.begin(), results.end(), [](const auto& result) { return result.hasValue(); })
+             ? EXIT_SUCCESS
+             : EXIT_FAILURE;
+}
@@ -0,0 +1,174 @@
+// TypeART library
+//
+// Copyright (c) 2017-2022 TypeART Authors
+// Distributed under the BSD 3-Clause license.
+// (See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/BSD-3-Clause)
+//
+// Project home: https://github.com/tudasc/TypeART
+//
+// SPDX-License-Identifier: BSD-3-Clause
+//
+
+#include "TraceFormat.h"
+#include "TypeDB.h"
+#include "TypeIO.h"
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+enum class OutputFormat { text, csv };
+}  // namespace
+
+static cl::OptionCategory decode_category("TypeART event trace decoder");
+
+static cl::opt<std::string> cl_trace(cl::Positional, cl::desc("<trace file>"), cl::Required,
+                                     cl::cat(decode_category));
+
+static cl::opt<OutputFormat> cl_format(
+    "format", cl::desc("Output format:"),
+    cl::values(clEnumValN(OutputFormat::text, "text", "One event per line (default)"),
+               clEnumValN(OutputFormat::csv, "csv", "Comma-separated values")),
+    cl::init(OutputFormat::text), cl::cat(decode_category));
+
+static cl::opt<std::string> cl_types("types", cl::desc("Type file to resolve the names of user-defined types"),
+                                     cl::value_desc("file"), cl::cat(decode_category));
+
+static cl::opt<bool> cl_sort("sort", cl::desc("Order the events of all threads by time"), cl::init(false),
+                             cl::cat(decode_category));
+
+static cl::opt<bool> cl_summary("summary", cl::desc("Only print the number of events per kind"), cl::init(false),
+                                cl::cat(decode_category));
+
+namespace {
+/**
+ * Converts record ticks to nanoseconds since the trace start, interpolated between the first and the last clock record.
+ */
+class Clock {
+  double first_ticks{0};
+  double first_ns{0};
+  double ns_per_tick{1.0};
+
+ public:
+  explicit Clock(const std::vector<typeart::trace::Record>& clocks) {
+    if (clocks.empty()) {
+      return;
+    }
+    const auto& first = clocks.front();
+    const auto& last  = clocks.back();
+    first_ticks       = static_cast<double>(first.timestamp);
+    first_ns          = static_cast<double>(first.count);
+    if (last.timestamp > first.timestamp) {
+      ns_per_tick =
+          static_cast<double>(last.count - first.count) / static_cast<double>(last.timestamp - first.timestamp);
+    }
+  }
+
+  [[nodiscard]] int64_t ns(uint64_t ticks) const {
+    return static_cast<int64_t>(first_ns + (static_cast<double>(ticks) - first_ticks) * ns_per_tick);
+  }
+};
+
+void print_summary(const std::vector<typeart::trace::Record>& records, raw_ostream& out) {
+  using typeart::trace::EventKind;
+  constexpr size_t num_kinds = static_cast<size_t>(EventKind::clock);
+  std::array<uint64_t, num_kinds> events{};
+  uint64_t lost{0};
+  uint64_t threads{0};
+  for (const auto& record : records) {
+    const auto kind = static_cast<size_t>(record.kind);
+    if (kind < num_kinds) {
+      ++events[kind];
+    }
+    if (record.kind == EventKind::dropped) {
+      lost += record.count;
+    }
+    threads = std::max<uint64_t>(threads, record.thread + uint64_t{1});
+  }
+  for (size_t kind = 1; kind < num_kinds; ++kind) {
+    out << typeart::trace::kind_name(static_cast<EventKind>(kind)) << ": " << events[kind] << "\n";
+  }
+  out << "lost: " << lost << "\n";
+  out << "threads: " << threads << "\n";
+}
+
+void print_records(const std::vector<typeart::trace::Record>& records, const Clock& clock,
+                   const typeart::TypeDB& type_db, raw_ostream& out) {
+  const bool csv = cl_format == OutputFormat::csv;
+  if (csv) {
+    out << "timestamp,thread,kind,address,type_id,type_name,count,site,status\n";
+  }
+  for (const auto& record : records) {
+    const auto& name     = type_db.getTypeName(record.type_id);
+    const auto* kind     = typeart::trace::kind_name(record.kind);
+    const auto timestamp = clock.ns(record.timestamp);
+    if (csv) {
+      out << timestamp << "," << record.thread << "," << kind << "," << format_hex(record.address, 2) << ","
+          << record.type_id << "," << name << "," << record.count << "," << format_hex(record.site, 2) << ","
+          << static_cast<unsigned>(record.status) << "\n";
+    } else {
+      out << timestamp << " T" << record.thread << " " << kind << " " << format_hex(record.address, 2) << " "
+          << record.type_id << " " << name << " " << record.count << " (" << format_hex(record.site, 2) << ") "
+          << static_cast<unsigned>(record.status) << "\n";
+    }
+  }
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  cl::HideUnrelatedOptions(decode_category);
+  cl::ParseCommandLineOptions(argc, argv,
+                              "Prints the binary event trace of the TypeART runtime (TYPEART_TRACE_FILE).\n");
+
+  auto buffer = MemoryBuffer::getFile(cl_trace, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+  if (!buffer) {
+    errs() << "Failed to read trace file " << cl_trace << ": " << buffer.getError().message() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  const StringRef data = buffer.get()->getBuffer();
+  std::vector<typeart::trace::Record> records;
+  if (!typeart::trace::read_records(data.data(), data.size(), records)) {
+    errs() << "Unsupported trace file (magic, version, byte order or record size): " << cl_trace << "\n";
+    return EXIT_FAILURE;
+  }
+
+  std::vector<typeart::trace::Record> clocks;
+  const auto is_clock = [](const auto& record) { return record.kind == typeart::trace::EventKind::clock; };
+  std::copy_if(records.begin(), records.end(), std::back_inserter(clocks), is_clock);
+  records.erase(std::remove_if(records.begin(), records.end(), is_clock), records.end());
+
+  if (cl_sort) {
+    std::stable_sort(records.begin(), records.end(),
+                     [](const auto& lhs, const auto& rhs) { return lhs.timestamp < rhs.timestamp; });
+  }
+
+  if (cl_summary) {
+    print_summary(records, outs());
+    return EXIT_SUCCESS;
+  }
+
+  typeart::TypeDB type_db;
+  if (!cl_types.empty()) {
+    auto loaded = typeart::io::load(&type_db, cl_types);
+    if (!loaded || !loaded.get()) {
+      errs() << "Failed to load type file " << cl_types << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  print_records(records, Clock{clocks}, type_db, outs());
+  return EXIT_SUCCESS;
+}
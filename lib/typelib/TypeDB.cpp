@@ -16,6 +16,11 @@
 #include "support/Logger.h"
 #include "typelib/TypeInterface.h"
 
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/xxhash.h"
+
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
 #include <utility>
 
@@ -45,9 +50,123 @@ const std::array<size_t, 11> TypeDB::BuiltinSizes = {1,  2,
 
 const std::string TypeDB::UnknownStructName{"typeart_unknown_struct"};
 
+namespace {
+inline size_t dense_slot(int type_id) {
+  return static_cast<size_t>(type_id - TYPEART_NUM_RESERVED_IDS);
+}
+
+inline bool fits_dense(size_t slot, size_t num_structs) {
+  // Grow the dense index as long as it stays reasonably filled:
+  constexpr size_t min_dense_slots{1024};
+  return slot < min_dense_slots || slot < 2 * num_structs;
+}
+
+inline size_t sparse_hash(int type_id) {
+  // Hashed IDs are uniform already, sequential IDs outside of the dense range are spread by the multiplication:
+  return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(type_id)) * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+/**
+ * Appends the runs of a signature. Runs are merged with the last run if contiguous, but never with a run of a preceding
+ * repeat run.
+ */
+class SignatureBuilder final {
+  std::vector<typeart_signature_entry> entries_;
+  // Entries before are part of a repeat run:
+  size_t sealed_{0};
+
+ public:
+  void appendRun(int type_id, size_t count, size_t offset) {
+    if (count == 0) {
+      return;
+    }
+    const size_t size = type_id == TYPEART_UNKNOWN_TYPE ? 1 : TypeDB::BuiltinSizes[type_id];
+    if (entries_.size() > sealed_) {
+      auto& last = entries_.back();
+      if (last.type_id == type_id && last.offset + last.count * size == offset) {
+        last.count += count;
+        return;
+      }
+    }
+    entries_.push_back(typeart_signature_entry{type_id, count, offset, 0, 0});
+  }
+
+  void appendPadding(size_t from, size_t to) {
+    if (from < to) {
+      appendRun(TYPEART_UNKNOWN_TYPE, to - from, from);
+    }
+  }
+
+  // Appends the runs of a (member) signature at the byte offset base:
+  void appendInline(const std::vector<typeart_signature_entry>& element, size_t base) {
+    size_t index{0};
+    while (index < element.size()) {
+      if (element[index].type_id != TYPEART_SIGNATURE_REPEAT) {
+        appendRun(element[index].type_id, element[index].count, base + element[index].offset);
+        ++index;
+        continue;
+      }
+      // A repeat run is copied as a whole:
+      const size_t end = index + 1 + element[index].length;
+      for (; index < end; ++index) {
+        auto entry = element[index];
+        entry.offset += base;
+        entries_.push_back(entry);
+      }
+      sealed_ = entries_.size();
+    }
+  }
+
+  // Appends count repetitions of a (member) signature of extent stride, starting at the byte offset:
+  void appendRepeat(const std::vector<typeart_signature_entry>& element, size_t count, size_t offset, size_t stride) {
+    if (element.size() == 1) {
+      // The single run covers the whole extent, i.e., the repetitions are contiguous:
+      const auto& run = element.front();
+      appendRun(run.type_id, run.count * count, offset + run.offset);
+      return;
+    }
+    if (count == 1 || element.empty()) {
+      appendInline(element, offset);
+      return;
+    }
+    entries_.push_back(typeart_signature_entry{TYPEART_SIGNATURE_REPEAT, count, offset, stride, element.size()});
+    for (auto entry : element) {
+      entry.offset += offset;
+      entries_.push_back(entry);
+    }
+    sealed_ = entries_.size();
+  }
+
+  [[nodiscard]] std::vector<typeart_signature_entry> take() {
+    return std::move(entries_);
+  }
+};
+
+TypeSignature make_builtin_signature(int type_id) {
+  TypeSignature signature;
+  signature.entries.push_back(typeart_signature_entry{type_id, 1, 0, 0, 0});
+  signature.hash = TypeDB::hashSignature(signature.entries.data(), signature.entries.size());
+  return signature;
+}
+
+const std::array<TypeSignature, TYPEART_NUM_VALID_IDS>& builtin_signatures() {
+  static const auto signatures = [] {
+    std::array<TypeSignature, TYPEART_NUM_VALID_IDS> result;
+    for (int type_id = 0; type_id < TYPEART_NUM_VALID_IDS; ++type_id) {
+      result[type_id] = make_builtin_signature(type_id);
+    }
+    return result;
+  }();
+  return signatures;
+}
+}  // namespace
+
 void TypeDB::clear() {
   struct_info_vec.clear();
-  typeid_to_list_index.clear();
+  signatures.clear();
+  dense_index.clear();
+  sparse_index.clear();
+  sparse_size = 0;
   // reverseTypeMap.clear();
 }
 
@@ -63,26 +182,82 @@ bool TypeDB::isStructType(int type_id) const {
   return type_id >= TYPEART_NUM_RESERVED_IDS;
 }
 
+const TypeDB::IndexEntry* TypeDB::findEntry(int type_id) const {
+  if (!isStructType(type_id)) {
+    return nullptr;
+  }
+  const auto slot = dense_slot(type_id);
+  if (slot < dense_index.size() && dense_index[slot].list_index >= 0) {
+    return &dense_index[slot];
+  }
+  // Not registered, or registered before the dense range covered the ID:
+  if (sparse_size == 0) {
+    return nullptr;
+  }
+  const size_t mask = sparse_index.size() - 1;
+  for (size_t position = sparse_hash(type_id) & mask;; position = (position + 1) & mask) {
+    const auto& candidate = sparse_index[position];
+    if (candidate.type_id == type_id) {
+      return &candidate.entry;
+    }
+    if (candidate.type_id == TYPEART_UNKNOWN_TYPE) {
+      return nullptr;
+    }
+  }
+}
+
+void TypeDB::insertSparse(int type_id, const IndexEntry& entry) {
+  // Keep the load factor at or below 1/2:
+  if (2 * (sparse_size + 1) > sparse_index.size()) {
+    std::vector<SparseEntry> previous(std::max<size_t>(16, 2 * sparse_index.size()));
+    previous.swap(sparse_index);
+    sparse_size = 0;
+    for (const auto& sparse_entry : previous) {
+      if (sparse_entry.type_id != TYPEART_UNKNOWN_TYPE) {
+        insertSparse(sparse_entry.type_id, sparse_entry.entry);
+      }
+    }
+  }
+  const size_t mask = sparse_index.size() - 1;
+  size_t position   = sparse_hash(type_id) & mask;
+  while (sparse_index[position].type_id != TYPEART_UNKNOWN_TYPE) {
+    position = (position + 1) & mask;
+  }
+  sparse_index[position] = SparseEntry{type_id, entry};
+  ++sparse_size;
+}
+
+int TypeDB::listIndexOf(int type_id) const {
+  const auto* entry = findEntry(type_id);
+  return entry != nullptr ? entry->list_index : -1;
+}
+
+int TypeDB::flagsOf(int type_id) const {
+  const auto* entry = findEntry(type_id);
+  return entry != nullptr ? entry->flags : 0;
+}
+
 bool TypeDB::isUserDefinedType(int type_id) const {
-  const auto* structInfo = getStructInfo(type_id);
-  return (structInfo != nullptr) &&
-         ((static_cast<int>(structInfo->flag) & static_cast<int>(StructTypeFlag::USER_DEFINED)) != 0);
+  return (flagsOf(type_id) & static_cast<int>(StructTypeFlag::USER_DEFINED)) != 0;
 }
 
 bool TypeDB::isVectorType(int type_id) const {
-  const auto* structInfo = getStructInfo(type_id);
-  return (structInfo != nullptr) &&
-         ((static_cast<int>(structInfo->flag) & static_cast<int>(StructTypeFlag::LLVM_VECTOR)) != 0);
+  return (flagsOf(type_id) & static_cast<int>(StructTypeFlag::LLVM_VECTOR)) != 0;
 }
 
 bool TypeDB::isValid(int type_id) const {
   if (isBuiltinType(type_id)) {
     return true;
   }
-  return typeid_to_list_index.find(type_id) != typeid_to_list_index.end();
+  return listIndexOf(type_id) >= 0;
 }
 
 void TypeDB::registerStruct(const StructTypeInfo& struct_type) {
+  registerRecord(std::make_shared<const StructTypeInfo>(struct_type));
+}
+
+void TypeDB::registerRecord(std::shared_ptr<const StructTypeInfo> record) {
+  const auto& struct_type = *record;
   if (isValid(struct_type.type_id) || !isStructType(struct_type.type_id)) {
     if (isBuiltinType(struct_type.type_id)) {
       LOG_ERROR("Built-in type ID used for struct " << struct_type.name);
@@ -96,8 +271,135 @@ void TypeDB::registerStruct(const StructTypeInfo& struct_type) {
     }
     return;
   }
-  struct_info_vec.push_back(struct_type);
-  typeid_to_list_index.insert({struct_type.type_id, struct_info_vec.size() - 1});
+  const IndexEntry entry{static_cast<int>(struct_info_vec.size()), static_cast<int>(struct_type.flag),
+                         struct_type.extent};
+  struct_info_vec.push_back(std::move(record));
+  signatures.emplace_back();
+
+  const auto slot = dense_slot(struct_type.type_id);
+  if (fits_dense(slot, struct_info_vec.size())) {
+    if (slot >= dense_index.size()) {
+      dense_index.resize(slot + 1);
+    }
+    dense_index[slot] = entry;
+  } else {
+    insertSparse(struct_type.type_id, entry);
+  }
+}
+
+const TypeSignature* TypeDB::signatureOf(int list_index, size_t depth) const {
+  auto& slot = signatures[list_index].signature;
+  if (const auto built = std::atomic_load(&slot)) {
+    return built.get();
+  }
+  // Member structs are nested less deep than the struct itself, a longer chain is a cycle (of a malformed type file):
+  if (depth > struct_info_vec.size()) {
+    LOG_ERROR("Cyclic member structs of " << struct_info_vec[list_index]->name);
+    return nullptr;
+  }
+  auto signature = buildSignature(*struct_info_vec[list_index], depth);
+  if (!signature) {
+    // A member struct is not registered (yet), the signature is built by a later query:
+    return nullptr;
+  }
+  // Signatures of concurrent queries are equal, the first one is kept:
+  std::shared_ptr<const TypeSignature> expected;
+  if (!std::atomic_compare_exchange_strong(&slot, &expected, signature)) {
+    return expected.get();
+  }
+  return signature.get();
+}
+
+std::shared_ptr<const TypeSignature> TypeDB::buildSignature(const StructTypeInfo& info, size_t depth) const {
+  SignatureBuilder builder;
+  size_t cursor{0};
+  for (size_t index = 0; index < info.num_members; ++index) {
+    const int member_type = info.member_types[index];
+    const size_t offset   = info.offsets[index];
+    const size_t count    = info.array_sizes[index];
+    if (isUnknown(member_type)) {
+      // Covered by padding up to the next member:
+      continue;
+    }
+    builder.appendPadding(cursor, offset);
+
+    if (isBuiltinType(member_type)) {
+      builder.appendRun(member_type, count, offset);
+      cursor = std::max(cursor, offset + count * BuiltinSizes[member_type]);
+      continue;
+    }
+
+    const int member_index = listIndexOf(member_type);
+    const auto* member_signature = member_index < 0 ? nullptr : signatureOf(member_index, depth + 1);
+    if (member_signature == nullptr) {
+      return nullptr;
+    }
+    const size_t extent = struct_info_vec[member_index]->extent;
+    if (count > 0) {
+      builder.appendRepeat(member_signature->entries, count, offset, extent);
+    }
+    cursor = std::max(cursor, offset + count * extent);
+  }
+  builder.appendPadding(cursor, info.extent);
+
+  auto signature     = std::make_shared<TypeSignature>();
+  signature->entries = builder.take();
+  signature->hash    = hashSignature(signature->entries.data(), signature->entries.size());
+  return signature;
+}
+
+const TypeSignature* TypeDB::getSignature(int type_id) const {
+  if (isBuiltinType(type_id)) {
+    return &builtin_signatures()[type_id];
+  }
+  const int list_index = listIndexOf(type_id);
+  if (list_index < 0) {
+    return nullptr;
+  }
+  return signatureOf(list_index, 0);
+}
+
+uint64_t TypeDB::hashSignature(const typeart_signature_entry* entries, size_t num_entries) {
+  // Fixed-width serialization, independent of the struct padding of typeart_signature_entry:
+  std::vector<uint64_t> words;
+  words.reserve(5 * num_entries);
+  for (size_t index = 0; index < num_entries; ++index) {
+    words.push_back(static_cast<uint64_t>(entries[index].type_id));
+    words.push_back(entries[index].count);
+    words.push_back(entries[index].offset);
+    words.push_back(entries[index].stride);
+    words.push_back(entries[index].length);
+  }
+  return llvm::xxHash64(llvm::StringRef{reinterpret_cast<const char*>(words.data()), words.size() * sizeof(uint64_t)});
+}
+
+std::vector<int> TypeDB::merge(const TypeDB& other) {
+  std::vector<int> conflicts;
+  for (const auto& record : other.struct_info_vec) {
+    const auto* known = getStructInfo(record->type_id);
+    if (known == nullptr) {
+      registerRecord(record);
+    } else if (known->name != record->name || known->extent != record->extent) {
+      conflicts.push_back(record->type_id);
+    }
+  }
+  return conflicts;
+}
+
+std::vector<int> TypeDB::mergeBatch(const TypeDB& other, const TypeDB& base) {
+  std::vector<int> conflicts;
+  for (const auto& record : other.struct_info_vec) {
+    const auto* known = base.getStructInfo(record->type_id);
+    if (known == nullptr) {
+      known = getStructInfo(record->type_id);
+    }
+    if (known == nullptr) {
+      registerRecord(record);
+    } else if (known->name != record->name || known->extent != record->extent) {
+      conflicts.push_back(record->type_id);
+    }
+  }
+  return conflicts;
 }
 
 const std::string& TypeDB::getTypeName(int type_id) const {
@@ -121,23 +423,38 @@ size_t TypeDB::getTypeSize(int type_id) const {
     return 0;
   }
 
-  const auto* structInfo = getStructInfo(type_id);
-  if (structInfo != nullptr) {
-    return structInfo->extent;
-  }
-  return 0;
+  const auto* entry = findEntry(type_id);
+  return entry != nullptr ? entry->extent : 0;
 }
 
 const StructTypeInfo* TypeDB::getStructInfo(int type_id) const {
-  const auto index_iter = typeid_to_list_index.find(type_id);
-  if (index_iter != typeid_to_list_index.end()) {
-    return &struct_info_vec[index_iter->second];
+  const int list_index = listIndexOf(type_id);
+  if (list_index >= 0) {
+    return struct_info_vec[list_index].get();
   }
   return nullptr;
 }
 
-const std::vector<StructTypeInfo>& TypeDB::getStructList() const {
-  return struct_info_vec;
+std::vector<StructTypeInfo> TypeDB::getStructList() const {
+  std::vector<StructTypeInfo> struct_list;
+  struct_list.reserve(struct_info_vec.size());
+  for (const auto& record : struct_info_vec) {
+    struct_list.push_back(*record);
+  }
+  return struct_list;
+}
+
+size_t TypeDB::getNumStructs() const {
+  return struct_info_vec.size();
+}
+
+std::vector<int> TypeDB::getStructIDs() const {
+  std::vector<int> type_ids;
+  type_ids.reserve(struct_info_vec.size());
+  for (const auto& record : struct_info_vec) {
+    type_ids.push_back(record->type_id);
+  }
+  return type_ids;
 }
 
 bool TypeDB::isUnknown(int type_id) const {
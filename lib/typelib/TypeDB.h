@@ -14,21 +14,48 @@
 #define LLVM_MUST_SUPPORT_TYPECONFIG_H
 
 #include "TypeDatabase.h"
+#include "TypeInterface.h"
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 namespace typeart {
 
+/**
+ * Primitive type signature of a type, the flattened sequence of built-in type runs (with explicit padding) of one
+ * element. Arrays of struct members are a single repeat run of the signature of the member struct. Equal layouts have
+ * equal signatures and hashes, independent of the struct nesting.
+ */
+struct TypeSignature {
+  std::vector<typeart_signature_entry> entries;
+  uint64_t hash{0};
+};
+
 class TypeDB final : public TypeDatabase {
  public:
   void clear();
 
   void registerStruct(const StructTypeInfo& struct_type) override;
 
+  /**
+   * Registers all struct types of other, which are not registered yet. A type registered under the same ID with a
+   * different name or extent is a conflict (e.g., a type ID hash collision), and is not merged.
+   * The (immutable) type records are shared with other, not copied.
+   * @return The conflicting type IDs.
+   */
+  std::vector<int> merge(const TypeDB& other);
+
+  /**
+   * As merge, for a batch of types to be merged into base later: Types of other registered in base are not registered
+   * again, conflicts with base are reported as well.
+   */
+  std::vector<int> mergeBatch(const TypeDB& other, const TypeDB& base);
+
   bool isUnknown(int type_id) const override;
 
   bool isValid(int type_id) const override;
@@ -49,15 +76,78 @@ class TypeDB final : public TypeDatabase {
 
   size_t getTypeSize(int type_id) const override;
 
-  const std::vector<StructTypeInfo>& getStructList() const override;
+  std::vector<StructTypeInfo> getStructList() const override;
+
+  size_t getNumStructs() const;
+
+  /**
+   * @return The IDs of all struct types, in registration order.
+   */
+  std::vector<int> getStructIDs() const;
+
+  /**
+   * The signature of a struct type is built on the first query (thread-safe), and shared by copies of the database.
+   * @return The signature of a built-in or struct type, or nullptr, if the type (or one of its member structs) is not
+   * registered.
+   */
+  const TypeSignature* getSignature(int type_id) const;
+
+  static uint64_t hashSignature(const typeart_signature_entry* entries, size_t num_entries);
 
   static const std::array<std::string, 11> BuiltinNames;
   static const std::array<size_t, 11> BuiltinSizes;
   static const std::string UnknownStructName;
 
  private:
-  std::vector<StructTypeInfo> struct_info_vec;
-  std::unordered_map<int, int> typeid_to_list_index;
+  // Signature of a struct type, nullptr until the first query. Only set once, concurrent queries access it atomically:
+  struct SignatureSlot {
+    mutable std::shared_ptr<const TypeSignature> signature;
+
+    SignatureSlot() = default;
+
+    SignatureSlot(const SignatureSlot& other) : signature(std::atomic_load(&other.signature)) {
+    }
+
+    SignatureSlot& operator=(const SignatureSlot& other) {
+      std::atomic_store(&signature, std::atomic_load(&other.signature));
+      return *this;
+    }
+  };
+  // Records and signatures are immutable once built, copies of the database share them:
+  std::vector<std::shared_ptr<const StructTypeInfo>> struct_info_vec;
+  // Signatures by list index:
+  std::vector<SignatureSlot> signatures;
+  // Hot properties of a registered struct type, queried without touching its StructTypeInfo:
+  struct IndexEntry {
+    int list_index{-1};
+    int flags{0};
+    size_t extent{0};
+  };
+  struct SparseEntry {
+    int type_id{TYPEART_UNKNOWN_TYPE};
+    IndexEntry entry;
+  };
+  // Sequential struct IDs are allocated densely, and indexed by (type_id - TYPEART_NUM_RESERVED_IDS). Slots of
+  // unregistered IDs have list index -1.
+  std::vector<IndexEntry> dense_index;
+  // All other IDs, e.g., hashed struct IDs spread over the whole ID range. Open addressing with linear probing, the
+  // capacity is a power of two, empty slots have the (never registered) ID TYPEART_UNKNOWN_TYPE:
+  std::vector<SparseEntry> sparse_index;
+  size_t sparse_size{0};
+
+  [[nodiscard]] const IndexEntry* findEntry(int type_id) const;
+
+  void insertSparse(int type_id, const IndexEntry& entry);
+
+  [[nodiscard]] int listIndexOf(int type_id) const;
+
+  [[nodiscard]] int flagsOf(int type_id) const;
+
+  void registerRecord(std::shared_ptr<const StructTypeInfo> struct_type);
+
+  [[nodiscard]] const TypeSignature* signatureOf(int list_index, size_t depth) const;
+
+  [[nodiscard]] std::shared_ptr<const TypeSignature> buildSignature(const StructTypeInfo& info, size_t depth) const;
 };
 
 }  // namespace typeart
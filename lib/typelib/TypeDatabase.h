@@ -58,7 +58,7 @@ class TypeDatabase {
 
   [[nodiscard]] virtual size_t getTypeSize(int type_id) const = 0;
 
-  [[nodiscard]] virtual const std::vector<StructTypeInfo>& getStructList() const = 0;
+  [[nodiscard]] virtual std::vector<StructTypeInfo> getStructList() const = 0;
 
   virtual ~TypeDatabase() = default;
 };
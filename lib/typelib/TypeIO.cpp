@@ -14,6 +14,7 @@
 
 #include "TypeDB.h"
 #include "TypeDatabase.h"
+#include "TypeJournal.h"
 #include "support/Logger.h"
 
 #include "llvm/ADT/StringRef.h"
@@ -23,8 +24,12 @@
 #include "llvm/Support/YAMLTraits.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <array>
+#include <cstdint>
+#include <cstring>
 #include <memory>
 #include <system_error>
+#include <type_traits>
 #include <vector>
 
 using namespace llvm::yaml;
@@ -81,9 +86,135 @@ LLVM_YAML_IS_SEQUENCE_VECTOR(typeart::StructTypeInfo)
 
 namespace typeart::io {
 
+namespace binary {
+/**
+ * Binary type file (version 1), a flat layout with native byte order, all references are relative to the file start:
+ * Header | StructRecord[num_structs] | uint64 offsets[num_members] | uint64 counts[num_members] |
+ * int32 types[num_members] (padded to 8 bytes) | names (not null-terminated)
+ */
+constexpr std::array<char, 8> Magic{'T', 'Y', 'P', 'E', 'A', 'R', 'T', 'B'};
+constexpr uint32_t Version{1};
+constexpr uint32_t ByteOrderMark{0x01020304};
+
+struct Header {
+  std::array<char, 8> magic;
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t num_structs;
+  uint64_t num_members;
+  uint64_t names_size;
+};
+
+struct StructRecord {
+  int32_t type_id;
+  int32_t flags;
+  uint64_t extent;
+  uint64_t member_begin;
+  uint64_t num_members;
+  uint64_t name_begin;
+  uint64_t name_length;
+};
+
+static_assert(std::is_trivially_copyable_v<Header> && std::is_trivially_copyable_v<StructRecord>);
+
+inline uint64_t padded(uint64_t bytes) {
+  return (bytes + 7) & ~uint64_t{7};
+}
+
+inline bool is_binary(llvm::StringRef buffer) {
+  return buffer.size() >= Magic.size() && std::memcmp(buffer.data(), Magic.data(), Magic.size()) == 0;
+}
+
+template <typename T>
+inline const T* array_at(llvm::StringRef buffer, uint64_t offset, uint64_t count) {
+  if (offset > buffer.size() || count > (buffer.size() - offset) / sizeof(T)) {
+    return nullptr;
+  }
+  return reinterpret_cast<const T*>(buffer.data() + offset);
+}
+
+std::error_code load(TypeDB* typeDB, llvm::StringRef buffer) {
+  const auto invalid = std::make_error_code(std::errc::invalid_argument);
+
+  const auto* header = array_at<Header>(buffer, 0, 1);
+  if (header == nullptr || header->version != Version || header->byte_order != ByteOrderMark) {
+    return invalid;
+  }
+
+  uint64_t offset{sizeof(Header)};
+  const auto* records = array_at<StructRecord>(buffer, offset, header->num_structs);
+  offset += header->num_structs * sizeof(StructRecord);
+  const auto* offsets = array_at<uint64_t>(buffer, offset, header->num_members);
+  offset += header->num_members * sizeof(uint64_t);
+  const auto* counts = array_at<uint64_t>(buffer, offset, header->num_members);
+  offset += header->num_members * sizeof(uint64_t);
+  const auto* types = array_at<int32_t>(buffer, offset, header->num_members);
+  offset += padded(header->num_members * sizeof(int32_t));
+  const auto* names = array_at<char>(buffer, offset, header->names_size);
+  if (records == nullptr || offsets == nullptr || counts == nullptr || types == nullptr || names == nullptr) {
+    return invalid;
+  }
+
+  for (uint64_t index = 0; index < header->num_structs; ++index) {
+    const auto& record = records[index];
+    if (record.member_begin > header->num_members || record.num_members > header->num_members - record.member_begin ||
+        record.name_begin > header->names_size || record.name_length > header->names_size - record.name_begin) {
+      return invalid;
+    }
+    const auto member_begin = record.member_begin;
+    const auto member_end   = member_begin + record.num_members;
+    typeDB->registerStruct(StructTypeInfo{record.type_id,
+                                          std::string{names + record.name_begin, record.name_length},
+                                          record.extent,
+                                          record.num_members,
+                                          {offsets + member_begin, offsets + member_end},
+                                          {types + member_begin, types + member_end},
+                                          {counts + member_begin, counts + member_end},
+                                          static_cast<StructTypeFlag>(record.flags)});
+  }
+  return {};
+}
+
+void store(const std::vector<StructTypeInfo>& types, llvm::raw_ostream& out) {
+  Header header{Magic, Version, ByteOrderMark, types.size(), 0, 0};
+  std::vector<StructRecord> records;
+  records.reserve(types.size());
+  for (const auto& info : types) {
+    records.push_back(StructRecord{info.type_id, static_cast<int32_t>(info.flag), info.extent, header.num_members,
+                                   info.num_members, header.names_size, info.name.size()});
+    header.num_members += info.num_members;
+    header.names_size += info.name.size();
+  }
+
+  const auto write = [&out](const auto* data, size_t count) {
+    out.write(reinterpret_cast<const char*>(data), count * sizeof(*data));
+  };
+  write(&header, 1);
+  write(records.data(), records.size());
+  for (const auto& info : types) {
+    const std::vector<uint64_t> offsets(info.offsets.begin(), info.offsets.end());
+    write(offsets.data(), offsets.size());
+  }
+  for (const auto& info : types) {
+    const std::vector<uint64_t> counts(info.array_sizes.begin(), info.array_sizes.end());
+    write(counts.data(), counts.size());
+  }
+  for (const auto& info : types) {
+    const std::vector<int32_t> member_types(info.member_types.begin(), info.member_types.end());
+    write(member_types.data(), member_types.size());
+  }
+  out.write_zeros(padded(header.num_members * sizeof(int32_t)) - header.num_members * sizeof(int32_t));
+  for (const auto& info : types) {
+    out << info.name;
+  }
+}
+}  // namespace binary
+
 llvm::ErrorOr<bool> load(TypeDB* typeDB, const std::string& file) {
   using namespace llvm;
-  ErrorOr<std::unique_ptr<MemoryBuffer>> memBuffer = MemoryBuffer::getFile(file);
+  // Binary files and journals are mapped (if large enough) and read in place:
+  ErrorOr<std::unique_ptr<MemoryBuffer>> memBuffer =
+      MemoryBuffer::getFile(file, /*IsText=*/false, /*RequiresNullTerminator=*/false);
 
   if (std::error_code error = memBuffer.getError(); error) {
     // TODO meaningful error handling/message
@@ -93,6 +224,22 @@ llvm::ErrorOr<bool> load(TypeDB* typeDB, const std::string& file) {
 
   typeDB->clear();
 
+  if (binary::is_binary(memBuffer.get()->getBuffer())) {
+    if (std::error_code error = binary::load(typeDB, memBuffer.get()->getBuffer()); error) {
+      LOG_WARNING("Warning while loading binary type file " << file << ". Reason: " << error.message());
+      return error;
+    }
+    return true;
+  }
+
+  if (is_journal(memBuffer.get()->getBuffer())) {
+    if (std::error_code error = load_journal(typeDB, memBuffer.get()->getBuffer()); error) {
+      LOG_WARNING("Warning while loading type journal " << file << ". Reason: " << error.message());
+      return error;
+    }
+    return true;
+  }
+
   yaml::Input in(memBuffer.get()->getMemBufferRef());
   std::vector<StructTypeInfo> structures;
   in >> structures;
@@ -104,11 +251,26 @@ llvm::ErrorOr<bool> load(TypeDB* typeDB, const std::string& file) {
   return !in.error();
 }
 
-llvm::ErrorOr<bool> store(const TypeDB* typeDB, const std::string& file) {
+llvm::ErrorOr<bool> load_binary(TypeDB* typeDB, llvm::StringRef buffer) {
+  if (!binary::is_binary(buffer)) {
+    return std::make_error_code(std::errc::invalid_argument);
+  }
+  if (std::error_code error = binary::load(typeDB, buffer); error) {
+    return error;
+  }
+  return true;
+}
+
+void store_binary(const std::vector<StructTypeInfo>& types, llvm::raw_ostream& out) {
+  binary::store(types, out);
+}
+
+llvm::ErrorOr<bool> store(const TypeDB* typeDB, const std::string& file, TypeFileFormat format) {
   using namespace llvm;
 
   std::error_code error;
-  raw_fd_ostream oss(StringRef(file), error, compat::open_flag());
+  raw_fd_ostream oss(StringRef(file), error,
+                     format == TypeFileFormat::yaml ? compat::open_flag() : sys::fs::OpenFlags::OF_None);
 
   if (oss.has_error()) {
     LOG_WARNING("Warning while storing type file to " << file << ". Reason: " << error.message());
@@ -116,6 +278,15 @@ llvm::ErrorOr<bool> store(const TypeDB* typeDB, const std::string& file) {
   }
 
   auto types = typeDB->getStructList();
+  if (format == TypeFileFormat::binary) {
+    store_binary(types, oss);
+    return true;
+  }
+  if (format == TypeFileFormat::journal) {
+    store_journal(types, oss);
+    return true;
+  }
+
   yaml::Output out(oss);
   if (!types.empty()) {
     out << types;
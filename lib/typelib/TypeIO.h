@@ -13,17 +13,39 @@
 #ifndef LLVM_MUST_SUPPORT_CONFIGIO_H
 #define LLVM_MUST_SUPPORT_CONFIGIO_H
 
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/ErrorOr.h"
 
 #include <string>
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+}  // namespace llvm
 
 namespace typeart {
 
 class TypeDB;
+struct StructTypeInfo;
 
 namespace io {
+enum class TypeFileFormat { yaml, binary, journal };
+
+/**
+ * Loads a type file, the format (YAML, binary or journal) is detected automatically.
+ */
 [[nodiscard]] llvm::ErrorOr<bool> load(TypeDB* db, const std::string& file);
-[[nodiscard]] llvm::ErrorOr<bool> store(const TypeDB* db, const std::string& file);
+
+[[nodiscard]] llvm::ErrorOr<bool> store(const TypeDB* db, const std::string& file,
+                                        TypeFileFormat format = TypeFileFormat::yaml);
+
+/**
+ * Registers the struct types of an in-memory binary type table (e.g., embedded in an object file) in addition to the
+ * already registered types of db. The buffer must be 8-byte aligned.
+ */
+[[nodiscard]] llvm::ErrorOr<bool> load_binary(TypeDB* db, llvm::StringRef buffer);
+
+void store_binary(const std::vector<StructTypeInfo>& types, llvm::raw_ostream& out);
 }  // namespace io
 
 }  // namespace typeart
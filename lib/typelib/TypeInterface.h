@@ -36,10 +36,26 @@ typedef enum typeart_builtin_type_t {                  // NOLINT
   TYPEART_PPC_FP128        = 9,                        // ICM extended precision 128-bit floating point type
   TYPEART_POINTER          = 10,                       // Represents all pointer types
   TYPEART_NUM_VALID_IDS    = TYPEART_POINTER + 1,      // Number of valid built-in types
+  TYPEART_SIGNATURE_REPEAT = 254,                      // Repeat run of a type signature (not a type)
   TYPEART_UNKNOWN_TYPE     = 255,                      // Placeholder for unknown types
   TYPEART_NUM_RESERVED_IDS = TYPEART_UNKNOWN_TYPE + 1  // Represents user-defined types
 } typeart_builtin_type;
 
+/**
+ * A run of a primitive type signature: count consecutive elements of a built-in type, starting at the byte offset.
+ * Padding is explicit, as a run of type TYPEART_UNKNOWN_TYPE with count bytes.
+ * A run of type TYPEART_SIGNATURE_REPEAT (e.g., of an array of structs) repeats the following length entries count
+ * times, each repetition stride bytes after the previous one. The following entries are the first repetition, starting
+ * at the byte offset.
+ */
+typedef struct typeart_signature_entry_t {  // NOLINT
+  int type_id;
+  size_t count;
+  size_t offset;
+  size_t stride;  // Repeat runs only, 0 otherwise
+  size_t length;  // Repeat runs only, 0 otherwise
+} typeart_signature_entry;
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,244 @@
+// TypeART library
+//
+// Copyright (c) 2017-2022 TypeART Authors
+// Distributed under the BSD 3-Clause license.
+// (See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/BSD-3-Clause)
+//
+// Project home: https://github.com/tudasc/TypeART
+//
+// SPDX-License-Identifier: BSD-3-Clause
+//
+
+#include "TypeJournal.h"
+
+#include "TypeDB.h"
+#include "TypeIO.h"
+#include "support/Logger.h"
+
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+
+namespace typeart::io {
+
+namespace {
+constexpr std::array<char, 8> JournalMagic{'T', 'Y', 'P', 'E', 'A', 'R', 'T', 'J'};
+constexpr uint32_t JournalVersion{1};
+constexpr uint32_t JournalByteOrderMark{0x01020304};
+
+struct JournalHeader {
+  std::array<char, 8> magic;
+  uint32_t version;
+  uint32_t byte_order;
+};
+
+static_assert(std::is_trivially_copyable_v<JournalHeader> && sizeof(JournalHeader) % 8 == 0);
+
+inline std::error_code last_error() {
+  return {errno, std::generic_category()};
+}
+
+std::error_code write_all(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    const auto written = ::write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return last_error();
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+  }
+  return {};
+}
+
+/**
+ * Size of the journal up to the end of the last complete segment.
+ */
+uint64_t complete_size(int fd, uint64_t end) {
+  uint64_t offset{sizeof(JournalHeader)};
+  while (end > offset && end - offset >= sizeof(uint64_t)) {
+    uint64_t size{0};
+    if (::pread(fd, &size, sizeof(size), static_cast<off_t>(offset)) != static_cast<ssize_t>(sizeof(size)) ||
+        size > end - offset - sizeof(size)) {
+      break;
+    }
+    offset += sizeof(size) + size;
+  }
+  return std::min(offset, end);
+}
+
+void write_header(llvm::raw_ostream& out) {
+  const JournalHeader header{JournalMagic, JournalVersion, JournalByteOrderMark};
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void write_segment(const std::vector<StructTypeInfo>& types, llvm::raw_ostream& out) {
+  std::string table;
+  llvm::raw_string_ostream table_out(table);
+  store_binary(types, table_out);
+  table_out.flush();
+  // Keeps the following segment 8-byte aligned:
+  table.resize((table.size() + 7) & ~size_t{7}, '\0');
+
+  const uint64_t size = table.size();
+  out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+  out << table;
+}
+}  // namespace
+
+TypeJournal::TypeJournal(std::string journal_file) : file(std::move(journal_file)) {
+}
+
+TypeJournal::~TypeJournal() {
+  unlock();
+}
+
+std::error_code TypeJournal::lock() {
+  if (isLocked()) {
+    return {};
+  }
+  fd = ::open(file.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return last_error();
+  }
+  while (::flock(fd, LOCK_EX) != 0) {
+    if (errno != EINTR) {
+      const auto error = last_error();
+      unlock();
+      return error;
+    }
+  }
+
+  struct stat status {};
+  if (::fstat(fd, &status) != 0) {
+    const auto error = last_error();
+    unlock();
+    return error;
+  }
+  if (status.st_size == 0) {
+    std::string header;
+    llvm::raw_string_ostream header_out(header);
+    write_header(header_out);
+    header_out.flush();
+    if (const auto error = write_all(fd, header.data(), header.size()); error) {
+      unlock();
+      return error;
+    }
+    return {};
+  }
+
+  // Never append to a type file of another format:
+  std::array<char, JournalMagic.size()> magic{};
+  if (::pread(fd, magic.data(), magic.size(), 0) != static_cast<ssize_t>(magic.size()) ||
+      !is_journal(llvm::StringRef{magic.data(), magic.size()})) {
+    LOG_ERROR("Type file " << file << " is not a type journal.");
+    unlock();
+    return std::make_error_code(std::errc::invalid_argument);
+  }
+
+  // A torn segment (e.g., of a crashed compilation) is truncated, new segments follow the last complete one:
+  const auto end      = static_cast<uint64_t>(status.st_size);
+  const auto complete = complete_size(fd, end);
+  if (complete != end) {
+    LOG_WARNING("Removing incomplete type journal segment at offset " << complete << " of " << file);
+    if (::ftruncate(fd, static_cast<off_t>(complete)) != 0) {
+      const auto error = last_error();
+      unlock();
+      return error;
+    }
+  }
+  return {};
+}
+
+void TypeJournal::unlock() {
+  if (fd < 0) {
+    return;
+  }
+  // Closing the descriptor releases the lock:
+  ::close(fd);
+  fd = -1;
+}
+
+bool TypeJournal::isLocked() const {
+  return fd >= 0;
+}
+
+std::error_code TypeJournal::append(const std::vector<StructTypeInfo>& types) {
+  if (!isLocked()) {
+    return std::make_error_code(std::errc::bad_file_descriptor);
+  }
+  if (types.empty()) {
+    return {};
+  }
+  std::string segment;
+  llvm::raw_string_ostream segment_out(segment);
+  write_segment(types, segment_out);
+  segment_out.flush();
+  return write_all(fd, segment.data(), segment.size());
+}
+
+bool is_journal(llvm::StringRef buffer) {
+  return buffer.size() >= JournalMagic.size() &&
+         std::memcmp(buffer.data(), JournalMagic.data(), JournalMagic.size()) == 0;
+}
+
+std::error_code load_journal(TypeDB* db, llvm::StringRef buffer) {
+  const auto invalid = std::make_error_code(std::errc::invalid_argument);
+
+  JournalHeader header{};
+  if (buffer.size() < sizeof(header)) {
+    return invalid;
+  }
+  std::memcpy(&header, buffer.data(), sizeof(header));
+  if (!is_journal(buffer) || header.version != JournalVersion || header.byte_order != JournalByteOrderMark) {
+    return invalid;
+  }
+
+  uint64_t offset{sizeof(header)};
+  while (buffer.size() - offset >= sizeof(uint64_t)) {
+    uint64_t size{0};
+    std::memcpy(&size, buffer.data() + offset, sizeof(size));
+    offset += sizeof(size);
+    if (size > buffer.size() - offset) {
+      LOG_WARNING("Ignoring incomplete type journal segment at offset " << offset);
+      break;
+    }
+
+    TypeDB segment;
+    if (auto loaded = load_binary(&segment, buffer.substr(offset, size)); !loaded) {
+      return loaded.getError();
+    }
+    const auto conflicts = db->merge(segment);
+    for (const int type_id : conflicts) {
+      LOG_ERROR("Journal type " << segment.getTypeName(type_id) << " conflicts with type " << db->getTypeName(type_id)
+                                << " (ID " << type_id << ").");
+    }
+    if (!conflicts.empty()) {
+      return invalid;
+    }
+    offset += size;
+  }
+  return {};
+}
+
+void store_journal(const std::vector<StructTypeInfo>& types, llvm::raw_ostream& out) {
+  write_header(out);
+  if (!types.empty()) {
+    write_segment(types, out);
+  }
+}
+
+}  // namespace typeart::io
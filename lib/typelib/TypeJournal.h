@@ -0,0 +1,83 @@
+// TypeART library
+//
+// Copyright (c) 2017-2022 TypeART Authors
+// Distributed under the BSD 3-Clause license.
+// (See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/BSD-3-Clause)
+//
+// Project home: https://github.com/tudasc/TypeART
+//
+// SPDX-License-Identifier: BSD-3-Clause
+//
+
+#ifndef TYPEART_TYPEJOURNAL_H
+#define TYPEART_TYPEJOURNAL_H
+
+#include "llvm/ADT/StringRef.h"
+
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+}  // namespace llvm
+
+namespace typeart {
+
+class TypeDB;
+struct StructTypeInfo;
+
+namespace io {
+
+/**
+ * Append-only type file, each compiled module appends a segment (a binary type table) with the types it added:
+ * JournalHeader | (uint64 segment size | binary type table, padded to 8 bytes)*
+ * A type may be contained in several segments, a torn segment at the end (e.g., of a crashed compilation) is ignored,
+ * and removed by the next writer (lock).
+ * Writers synchronize with an exclusive (advisory) lock on the file.
+ */
+class TypeJournal final {
+  std::string file;
+  int fd{-1};
+
+ public:
+  explicit TypeJournal(std::string journal_file);
+
+  TypeJournal(const TypeJournal&) = delete;
+  TypeJournal& operator=(const TypeJournal&) = delete;
+
+  ~TypeJournal();
+
+  /**
+   * Opens (or creates) the journal and blocks until the exclusive lock is acquired. The lock is held until unlock.
+   */
+  [[nodiscard]] std::error_code lock();
+
+  void unlock();
+
+  [[nodiscard]] bool isLocked() const;
+
+  /**
+   * Appends a segment with the given types, requires the lock.
+   */
+  [[nodiscard]] std::error_code append(const std::vector<StructTypeInfo>& types);
+};
+
+[[nodiscard]] bool is_journal(llvm::StringRef buffer);
+
+/**
+ * Registers the types of all segments, duplicates are skipped. A type registered under the same ID with a different
+ * name is a conflict and yields an error.
+ */
+[[nodiscard]] std::error_code load_journal(TypeDB* db, llvm::StringRef buffer);
+
+/**
+ * Writes a journal with a single segment (i.e., a compacted journal).
+ */
+void store_journal(const std::vector<StructTypeInfo>& types, llvm::raw_ostream& out);
+
+}  // namespace io
+}  // namespace typeart
+
+#endif  // TYPEART_TYPEJOURNAL_H
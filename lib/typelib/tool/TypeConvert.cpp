@@ -0,0 +1,81 @@
+// TypeART library
+//
+// Copyright (c) 2017-2022 TypeART Authors
+// Distributed under the BSD 3-Clause license.
+// (See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/BSD-3-Clause)
+//
+// Project home: https://github.com/tudasc/TypeART
+//
+// SPDX-License-Identifier: BSD-3-Clause
+//
+
+#include "TypeDB.h"
+#include "TypeIO.h"
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+
+using namespace llvm;
+
+static cl::OptionCategory convert_category("TypeART type file converter");
+
+// The last file is the output, all others are inputs:
+static cl::list<std::string> cl_files(cl::Positional, cl::desc("<input type files> <output type file>"),
+                                      cl::OneOrMore, cl::cat(convert_category));
+
+static cl::opt<typeart::io::TypeFileFormat> cl_format(
+    "format", cl::desc("Format of the output type file (the input format is detected automatically):"),
+    cl::values(clEnumValN(typeart::io::TypeFileFormat::binary, "binary", "Binary, memory-mappable format (default)"),
+               clEnumValN(typeart::io::TypeFileFormat::yaml, "yaml", "YAML format"),
+               clEnumValN(typeart::io::TypeFileFormat::journal, "journal",
+                          "Append-only journal (compacted, duplicates are removed)")),
+    cl::init(typeart::io::TypeFileFormat::binary), cl::cat(convert_category));
+
+int main(int argc, char** argv) {
+  cl::HideUnrelatedOptions(convert_category);
+  cl::ParseCommandLineOptions(argc, argv,
+                              "Converts TypeART type files between the YAML and binary format.\n"
+                              "Several input type files (with hashed type IDs) are merged into the output.\n");
+
+  if (cl_files.size() < 2) {
+    errs() << "Expected at least one input and one output type file\n";
+    return EXIT_FAILURE;
+  }
+  const std::string& output = cl_files[cl_files.size() - 1];
+
+  typeart::TypeDB type_db;
+  bool conflict{false};
+  for (size_t index = 0; index + 1 < cl_files.size(); ++index) {
+    const std::string& input = cl_files[index];
+    typeart::TypeDB input_db;
+    auto loaded = typeart::io::load(&input_db, input);
+    if (!loaded || !loaded.get()) {
+      errs() << "Failed to load type file " << input;
+      if (!loaded) {
+        errs() << ": " << loaded.getError().message();
+      }
+      errs() << "\n";
+      return EXIT_FAILURE;
+    }
+    for (const int type_id : type_db.merge(input_db)) {
+      errs() << "Type " << input_db.getTypeName(type_id) << " of " << input << " conflicts with type "
+             << type_db.getTypeName(type_id) << " (ID " << type_id << ")\n";
+      conflict = true;
+    }
+  }
+  if (conflict) {
+    return EXIT_FAILURE;
+  }
+
+  auto stored = typeart::io::store(&type_db, output, cl_format);
+  if (!stored) {
+    errs() << "Failed to store type file " << output << ": " << stored.getError().message() << "\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
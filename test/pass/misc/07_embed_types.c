@@ -0,0 +1,21 @@
+// RUN: %c-to-llvm %s | %apply-typeart -typeart-stack -typeart-embed-types -S 2>&1 | %filecheck %s
+
+struct Datastruct {
+  int start;
+  double middle;
+  float end;
+};
+
+// The type table is registered before the globals of the module:
+// CHECK: @llvm.global_ctors = {{.*}} @__typeart_register_module_types, {{.*}} @__typeart_init_module_globals
+// CHECK: @__typeart_type_table = private constant [{{[0-9]+}} x i8] c"TYPEARTB{{.*}}struct.Datastruct", section "typeart_types", align 8
+
+struct Datastruct global_data;
+
+void foo() {
+  struct Datastruct data = {0};
+}
+
+// CHECK: define internal void @__typeart_register_module_types()
+// CHECK-NEXT: entry:
+// CHECK-NEXT: call void @__typeart_register_types(i8* getelementptr inbounds ({{.*}} @__typeart_type_table, i32 0, i32 0), i64 [[SIZE:[0-9]+]])
@@ -0,0 +1,34 @@
+// clang-format off
+// RUN: rm -f %t.yaml
+// RUN: %c-to-llvm %s | %apply-typeart -typeart-stack -typeart-types=%t.yaml -S > /dev/null 2>&1
+// RUN: %c-to-llvm -DSECOND_MODULE %s | %apply-typeart -typeart-stack -typeart-embed-types -typeart-types=%t.yaml -S 2>&1 | %filecheck %s --implicit-check-not=struct.Other
+// clang-format on
+
+// The shared type file contains the types of all modules, only the types used by a module (including nested
+// structs) are embedded in it:
+// CHECK: @__typeart_type_table = private constant [{{[0-9]+}} x i8] c"TYPEARTB{{.*}}struct.Outerstruct.Inner", section "typeart_types"
+
+#ifndef SECOND_MODULE
+struct Other {
+  int a;
+  float b;
+};
+
+void foo() {
+  struct Other other = {0};
+}
+#else
+struct Inner {
+  int a;
+  int b;
+};
+
+struct Outer {
+  struct Inner inner;
+  double c;
+};
+
+void bar() {
+  struct Outer outer = {0};
+}
+#endif
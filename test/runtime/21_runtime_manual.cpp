@@ -129,7 +129,7 @@ void test_global(softcounter::AccessRecorder& recorder) {
 }
 
 int main() {
-  softcounter::AccessRecorder recorder;
+  softcounter::AccessRecorder recorder{softcounter::DistinctConfig::exact()};
 
   test_heap(recorder);
   test_stack(recorder);
@@ -20,7 +20,7 @@ int main(int argc, char** argv) {
   // CHECK: [Trace] Alloc 0x{{[0-9a-f]+}} 6 double 8 6
   __typeart_alloc_stack(reinterpret_cast<const void*>(&d[0]), type, extent);
 
-  // CHECK: [Trace] Freeing stack (1)  1
+  // CHECK: [Trace] Freeing stack (1){{$}}
   // CHECK: [Trace] Free 0x{{[0-9a-f]+}} 6 double 8 6
   // CHECK: [Trace] Stack after free: 0
   __typeart_leave_scope(1);
@@ -33,7 +33,7 @@ int main(int argc, char** argv) {
   // CHECK: [Trace] Alloc 0x{{[0-9a-f]+}} 6 double 8 1
   __typeart_alloc_stack(reinterpret_cast<const void*>(&d[1]), type, 1);
   // CHECK: [Error]{{.*}}Stack is smaller than requested de-allocation count. alloca_count: 3. size: 2
-  // CHECK: [Trace] Freeing stack (2)  2
+  // CHECK: [Trace] Freeing stack (2){{$}}
   __typeart_leave_scope(3);
   return 0;
 }
@@ -4,8 +4,9 @@
 
 int main(int argc, char** argv) {
   const int n = 42;
+  // Allocations of built-in types do not load the type file:
   // CHECK: [Trace] TypeART Runtime Trace
-  // CHECK: [Warning]{{.*}}No type file with default name
+  // CHECK-NOT: No type file with default name
   // CHECK: [Trace] Alloc 0x{{.*}} int8 1 42
   char* a     = malloc(n * sizeof(char));
   // CHECK: [Trace] Free 0x{{.*}}
@@ -0,0 +1,56 @@
+// RUN: %run %s --manual 2>&1 | %filecheck %s
+
+#include "../../lib/runtime/CallbackInterface.h"
+#include "util.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Large allocations span many address regions (and, with TYPEART_SHARDED_MAP, many shards).
+// Interior pointers must resolve to the base allocation stored in a preceding region.
+
+void type_check(const void* addr) {
+  int id_result         = 0;
+  size_t count_check    = 0;
+  typeart_status status = typeart_get_type(addr, &id_result, &count_check);
+
+  if (status != TYPEART_OK) {
+    fprintf(stderr, "Status not OK: %s\n", err_code_to_string(status));
+  } else {
+    fprintf(stderr, "Status OK: type_id=%i count=%zu\n", id_result, count_check);
+  }
+}
+
+int main(void) {
+  const size_t extent_a = 65536;  // 512 KiB of double
+  const size_t extent_b = 4;
+  const char* base_a    = (const char*)(uintptr_t)0x10000000;
+  const char* base_b    = base_a + extent_a * sizeof(double);
+
+  __typeart_alloc((const void*)base_a, TYPEART_DOUBLE, extent_a);
+  __typeart_alloc((const void*)base_b, TYPEART_FLOAT, extent_b);
+
+  // CHECK: Status OK: type_id=6 count=65536
+  type_check(base_a);
+  // CHECK: Status OK: type_id=6 count=28036
+  type_check(base_a + 300000);
+  // CHECK: Status OK: type_id=6 count=1
+  type_check(base_a + (extent_a - 1) * sizeof(double));
+  // CHECK: Status OK: type_id=5 count=4
+  type_check(base_b);
+  // CHECK: Status OK: type_id=5 count=3
+  type_check(base_b + sizeof(float));
+  // CHECK: Status not OK: TYPEART_UNKNOWN_ADDRESS
+  type_check(base_b + extent_b * sizeof(float) + 8192);
+
+  __typeart_free((const void*)base_b);
+  // Base of "a" must be found, but the address is out of bounds:
+  // CHECK: Status not OK: TYPEART_UNKNOWN_ADDRESS
+  type_check(base_b + sizeof(float));
+
+  __typeart_free((const void*)base_a);
+  // CHECK: Status not OK: TYPEART_UNKNOWN_ADDRESS
+  type_check(base_a + 300000);
+
+  return 0;
+}
@@ -0,0 +1,63 @@
+// RUN: %run %s --manual 2>&1 | %filecheck %s
+
+#include "../../lib/runtime/CallbackInterface.h"
+#include "util.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Address ranges of large allocations are reused by smaller and overlapping allocations.
+// With TYPEART_SHADOW_MAP, stale shadow entries of the previous owner must not be reported.
+
+void type_check(const void* addr) {
+  int id_result         = 0;
+  size_t count_check    = 0;
+  typeart_status status = typeart_get_type(addr, &id_result, &count_check);
+
+  if (status != TYPEART_OK) {
+    fprintf(stderr, "Status not OK: %s\n", err_code_to_string(status));
+  } else {
+    fprintf(stderr, "Status OK: type_id=%i count=%zu\n", id_result, count_check);
+  }
+}
+
+int main(void) {
+  const char* base = (const char*)(uintptr_t)0x20000000;
+
+  __typeart_alloc((const void*)base, TYPEART_DOUBLE, 4096);
+  // CHECK: Status OK: type_id=6 count=3072
+  type_check(base + 8192);
+  __typeart_free((const void*)base);
+
+  // Smaller allocation at the same base, the tail of the old range is unknown:
+  __typeart_alloc((const void*)base, TYPEART_INT32, 16);
+  // CHECK: Status OK: type_id=2 count=16
+  type_check(base);
+  // CHECK: Status not OK: TYPEART_UNKNOWN_ADDRESS
+  type_check(base + 8192);
+  __typeart_free((const void*)base);
+
+  // Large allocation followed by an allocation inside its range (e.g., missed free):
+  __typeart_alloc((const void*)base, TYPEART_DOUBLE, 4096);
+  __typeart_alloc((const void*)(base + 16384), TYPEART_FLOAT, 2048);
+  // CHECK: Status OK: type_id=6 count=4096
+  type_check(base);
+  // CHECK: Status OK: type_id=6 count=2049
+  type_check(base + 16376);
+  // CHECK: Status OK: type_id=5 count=1024
+  type_check(base + 16384 + 4096);
+  // CHECK: Status OK: type_id=5 count=1
+  type_check(base + 16384 + 8188);
+  // CHECK: Status OK: type_id=5 count=2
+  type_check(base + 24576 - 8);
+
+  __typeart_free((const void*)(base + 16384));
+  // Range is resolved to the enclosing allocation again:
+  // CHECK: Status OK: type_id=6 count=1596
+  type_check(base + 20000);
+  __typeart_free((const void*)base);
+  // CHECK: Status not OK: TYPEART_UNKNOWN_ADDRESS
+  type_check(base + 20000);
+
+  return 0;
+}
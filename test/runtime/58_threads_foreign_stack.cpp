@@ -0,0 +1,76 @@
+// clang-format off
+// RUN: %run %s --thread --manual 2>&1 | %filecheck %s --check-prefix=CHECK-TSAN
+// RUN: %run %s --thread --manual 2>&1 | %filecheck %s
+// REQUIRES: thread
+// clang-format on
+
+#include "../../lib/runtime/CallbackInterface.h"
+#include "util.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+// Stack allocations are tracked per thread, other threads must still be able to resolve them.
+
+namespace {
+std::mutex m;
+std::condition_variable cv;
+const double* shared_addr{nullptr};
+bool query_done{false};
+}  // namespace
+
+void type_check(const void* addr) {
+  int id_result         = 0;
+  size_t count_check    = 0;
+  typeart_status status = typeart_get_type(addr, &id_result, &count_check);
+
+  if (status != TYPEART_OK) {
+    fprintf(stderr, "Status not OK: %s\n", err_code_to_string(status));
+  } else {
+    fprintf(stderr, "Status OK: type_id=%i count=%zu\n", id_result, count_check);
+  }
+}
+
+void owner() {
+  double d[16];
+  __typeart_alloc_stack(reinterpret_cast<const void*>(&d[0]), TYPEART_DOUBLE, 16);
+  {
+    std::unique_lock<std::mutex> lock(m);
+    shared_addr = &d[0];
+    cv.notify_all();
+    cv.wait(lock, [] { return query_done; });
+  }
+  __typeart_leave_scope(1);
+}
+
+int main(int argc, char** argv) {
+  std::thread t(owner);
+
+  const double* addr{nullptr};
+  {
+    std::unique_lock<std::mutex> lock(m);
+    cv.wait(lock, [] { return shared_addr != nullptr; });
+    addr = shared_addr;
+  }
+
+  // CHECK: Status OK: type_id=6 count=16
+  type_check(addr);
+  // CHECK: Status OK: type_id=6 count=12
+  type_check(addr + 4);
+
+  {
+    std::lock_guard<std::mutex> lock(m);
+    query_done = true;
+  }
+  cv.notify_all();
+  t.join();
+
+  // CHECK: Status not OK: TYPEART_UNKNOWN_ADDRESS
+  type_check(addr + 4);
+
+  // CHECK-TSAN-NOT: ThreadSanitizer
+
+  return 0;
+}
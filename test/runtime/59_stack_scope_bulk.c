@@ -0,0 +1,61 @@
+// RUN: %run %s --manual 2>&1 | %filecheck %s
+
+#include "../../lib/runtime/CallbackInterface.h"
+#include "util.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Leaving a scope removes all its allocations at once, regardless of their registration order.
+
+void type_check(const void* addr) {
+  int id_result         = 0;
+  size_t count_check    = 0;
+  typeart_status status = typeart_get_type(addr, &id_result, &count_check);
+
+  if (status != TYPEART_OK) {
+    fprintf(stderr, "Status not OK: %s\n", err_code_to_string(status));
+  } else {
+    fprintf(stderr, "Status OK: type_id=%i count=%zu\n", id_result, count_check);
+  }
+}
+
+int main(void) {
+  const char* frame = (const char*)(uintptr_t)0x30000000;
+
+  // Outer scope:
+  __typeart_alloc_stack((const void*)(frame + 1024), TYPEART_INT64, 4);
+
+  // Inner scope, registered in unsorted address order:
+  __typeart_alloc_stack((const void*)(frame + 256), TYPEART_DOUBLE, 2);
+  __typeart_alloc_stack((const void*)(frame + 128), TYPEART_FLOAT, 8);
+  __typeart_alloc_stack((const void*)(frame + 16), TYPEART_INT32, 4);
+  __typeart_alloc_stack((const void*)(frame + 64), TYPEART_INT8, 8);
+
+  // CHECK: Status OK: type_id=5 count=7
+  type_check(frame + 132);
+
+  // CHECK: [Trace] Freeing stack (4){{$}}
+  // CHECK-NEXT: [Trace] Free 0x{{[0-9a-f]+}} 6 double 8 2
+  // CHECK-NEXT: [Trace] Free 0x{{[0-9a-f]+}} 5 float 4 8
+  // CHECK-NEXT: [Trace] Free 0x{{[0-9a-f]+}} 2 int32 4 4
+  // CHECK-NEXT: [Trace] Free 0x{{[0-9a-f]+}} 0 int8 1 8
+  __typeart_leave_scope(4);
+
+  // CHECK: Status not OK: TYPEART_UNKNOWN_ADDRESS
+  type_check(frame + 16);
+  // CHECK: Status not OK: TYPEART_UNKNOWN_ADDRESS
+  type_check(frame + 64);
+  // CHECK: Status not OK: TYPEART_UNKNOWN_ADDRESS
+  type_check(frame + 128);
+  // CHECK: Status not OK: TYPEART_UNKNOWN_ADDRESS
+  type_check(frame + 256);
+  // CHECK: Status OK: type_id=3 count=3
+  type_check(frame + 1032);
+
+  __typeart_leave_scope(1);
+  // CHECK: Status not OK: TYPEART_UNKNOWN_ADDRESS
+  type_check(frame + 1024);
+
+  return 0;
+}
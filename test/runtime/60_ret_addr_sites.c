@@ -0,0 +1,48 @@
+// RUN: %run %s --manual 2>&1 | %filecheck %s
+
+#include "../../lib/runtime/CallbackInterface.h"
+#include "util.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Return addresses of allocations from the same call site are shared (with TYPEART_COMPACT_POINTER_INFO, they are
+// stored once in the call-site table), distinct call sites are kept apart.
+
+const void* ret_addr_of(const void* addr) {
+  const void* ret_addr = NULL;
+  typeart_get_return_address(addr, &ret_addr);
+  return ret_addr;
+}
+
+int main(void) {
+  const char* base = (const char*)(uintptr_t)0x40000000;
+
+  for (int i = 0; i < 4; ++i) {
+    __typeart_alloc((const void*)(base + i * 64), TYPEART_INT32, 16);
+  }
+  __typeart_alloc((const void*)(base + 1024), TYPEART_INT32, 16);
+
+  const void* site_loop = ret_addr_of(base);
+  if (site_loop == NULL) {
+    fprintf(stderr, "[Error] Missing return address\n");
+  }
+  for (int i = 1; i < 4; ++i) {
+    if (ret_addr_of(base + i * 64 + 4) != site_loop) {
+      fprintf(stderr, "[Error] Return address mismatch for allocation %i\n", i);
+    }
+  }
+  if (ret_addr_of(base + 1024) == site_loop || ret_addr_of(base + 1024) == NULL) {
+    fprintf(stderr, "[Error] Distinct call site not resolved\n");
+  }
+
+  __typeart_free((const void*)base);
+  if (ret_addr_of(base) != NULL) {
+    fprintf(stderr, "[Error] Return address of freed allocation\n");
+  }
+
+  // CHECK-NOT: [Error]
+  // CHECK: Done
+  fprintf(stderr, "Done\n");
+  return 0;
+}
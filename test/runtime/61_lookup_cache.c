@@ -0,0 +1,82 @@
+// RUN: %run %s --manual 2>&1 | %filecheck %s
+
+#include "../../lib/runtime/CallbackInterface.h"
+#include "util.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Repeated queries of the same buffers. With TYPEART_LOOKUP_CACHE, results are cached per thread and must be
+// invalidated by free, address reuse, and leaving a scope.
+
+void type_check(const void* addr) {
+  int id_result         = 0;
+  size_t count_check    = 0;
+  typeart_status status = typeart_get_type(addr, &id_result, &count_check);
+
+  if (status != TYPEART_OK) {
+    fprintf(stderr, "Status not OK: %s\n", err_code_to_string(status));
+  } else {
+    fprintf(stderr, "Status OK: type_id=%i count=%zu\n", id_result, count_check);
+  }
+}
+
+int main(void) {
+  const char* send = (const char*)(uintptr_t)0x50000000;
+  const char* recv = send + 4096;
+
+  __typeart_alloc((const void*)send, TYPEART_DOUBLE, 128);
+  __typeart_alloc((const void*)recv, TYPEART_DOUBLE, 128);
+
+  // CHECK: Status OK: type_id=6 count=128
+  // CHECK-NEXT: Status OK: type_id=6 count=64
+  // CHECK-NEXT: Status OK: type_id=6 count=64
+  // CHECK-NEXT: Status OK: type_id=6 count=128
+  for (int i = 0; i < 2; ++i) {
+    type_check(send + i * 512);
+    type_check(recv + (1 - i) * 512);
+  }
+
+  __typeart_free((const void*)send);
+  // CHECK: Status not OK: TYPEART_UNKNOWN_ADDRESS
+  type_check(send + 512);
+
+  // Address reuse (missing free) with a different type:
+  __typeart_alloc((const void*)recv, TYPEART_INT32, 16);
+  // CHECK: Status OK: type_id=2 count=8
+  type_check(recv + 32);
+
+  // Stack allocation of this thread:
+  __typeart_alloc_stack((const void*)send, TYPEART_FLOAT, 4);
+  // CHECK: Status OK: type_id=5 count=3
+  type_check(send + 4);
+  __typeart_leave_scope(1);
+  // CHECK: Status not OK: TYPEART_UNKNOWN_ADDRESS
+  type_check(send + 4);
+
+  // Allocation inside of an already cached allocation (e.g., missed free):
+  const char* outer = send + 8192;
+  __typeart_alloc((const void*)outer, TYPEART_DOUBLE, 512);
+  // CHECK: Status OK: type_id=6 count=256
+  type_check(outer + 2048);
+  __typeart_alloc((const void*)(outer + 2048), TYPEART_INT32, 64);
+  // CHECK: Status OK: type_id=2 count=60
+  type_check(outer + 2048 + 16);
+  // CHECK: Status OK: type_id=6 count=512
+  type_check(outer);
+  // CHECK: Status OK: type_id=2 count=1
+  type_check(outer + 2048 + 252);
+  __typeart_free((const void*)(outer + 2048));
+  __typeart_free((const void*)outer);
+
+  // Allocation inside of a freed (possibly pending) allocation, the allocator reused its memory:
+  __typeart_alloc((const void*)outer, TYPEART_DOUBLE, 512);
+  __typeart_free((const void*)outer);
+  __typeart_alloc((const void*)(outer + 1024), TYPEART_INT32, 16);
+  // CHECK: Status OK: type_id=2 count=12
+  type_check(outer + 1024 + 16);
+  __typeart_free((const void*)(outer + 1024));
+
+  __typeart_free((const void*)recv);
+  return 0;
+}
@@ -0,0 +1,60 @@
+// RUN: %run %s --manual 2>&1 | %filecheck %s
+
+#include "../../lib/runtime/CallbackInterface.h"
+#include "util.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Globals are kept in a separate, sorted table which is frozen on the first query.
+// Registrations after a query (e.g., of a dlopen-ed module) must still be found.
+
+void type_check(const void* addr) {
+  int id_result         = 0;
+  size_t count_check    = 0;
+  typeart_status status = typeart_get_type(addr, &id_result, &count_check);
+
+  if (status != TYPEART_OK) {
+    fprintf(stderr, "Status not OK: %s\n", err_code_to_string(status));
+  } else {
+    fprintf(stderr, "Status OK: type_id=%i count=%zu\n", id_result, count_check);
+  }
+}
+
+int main(void) {
+  const char* data = (const char*)(uintptr_t)0x60000000;
+
+  __typeart_alloc_global((const void*)(data + 512), TYPEART_FLOAT, 16);
+  __typeart_alloc_global((const void*)(data + 0), TYPEART_INT32, 8);
+  __typeart_alloc_global((const void*)(data + 128), TYPEART_DOUBLE, 2);
+  // Heap allocation in between globals:
+  __typeart_alloc((const void*)(data + 256), TYPEART_INT8, 64);
+
+  // CHECK: Status OK: type_id=2 count=7
+  type_check(data + 4);
+  // CHECK: Status OK: type_id=6 count=1
+  type_check(data + 136);
+  // CHECK: Status OK: type_id=0 count=32
+  type_check(data + 288);
+  // CHECK: Status OK: type_id=5 count=1
+  type_check(data + 572);
+  // CHECK: Status not OK: TYPEART_UNKNOWN_ADDRESS
+  type_check(data + 64);
+
+  __typeart_alloc_global((const void*)(data + 64), TYPEART_INT64, 4);
+  // CHECK: Status OK: type_id=3 count=4
+  type_check(data + 64);
+  // CHECK: Status OK: type_id=2 count=1
+  type_check(data + 28);
+
+  __typeart_free((const void*)(data + 256));
+  // CHECK: Status not OK: TYPEART_UNKNOWN_ADDRESS
+  type_check(data + 288);
+
+  // Heap allocation at the base of a global:
+  // CHECK: Pointer already in map
+  __typeart_alloc((const void*)(data + 128), TYPEART_INT8, 16);
+  __typeart_free((const void*)(data + 128));
+
+  return 0;
+}
@@ -0,0 +1,50 @@
+// RUN: %run %s --manual 2>&1 | %filecheck %s
+// RUN: TYPEART_MAP_BACKEND=mutex %run %s --manual 2>&1 | %filecheck %s
+// RUN: TYPEART_MAP_BACKEND=sharded %run %s --manual 2>&1 | %filecheck %s
+// RUN: TYPEART_MAP_BACKEND=left-right %run %s --manual 2>&1 | %filecheck %s
+// RUN: TYPEART_MAP_BACKEND=shadow:std %run %s --manual 2>&1 | %filecheck %s
+// RUN: TYPEART_MAP_BACKEND=unknown %run %s --manual 2>&1 | %filecheck %s
+
+#include "../../lib/runtime/CallbackInterface.h"
+#include "util.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+// With TYPEART_MAP_BACKEND_SELECTION, the map backend is chosen at startup. All backends (and unknown names, falling
+// back to the default) must behave the same. Without the option, the variable is ignored.
+
+void type_check(const void* addr) {
+  int id_result         = 0;
+  size_t count_check    = 0;
+  typeart_status status = typeart_get_type(addr, &id_result, &count_check);
+
+  if (status != TYPEART_OK) {
+    fprintf(stderr, "Status not OK: %s\n", err_code_to_string(status));
+  } else {
+    fprintf(stderr, "Status OK: type_id=%i count=%zu\n", id_result, count_check);
+  }
+}
+
+int main(void) {
+  const char* base = (const char*)(uintptr_t)0x70000000;
+
+  __typeart_alloc((const void*)base, TYPEART_DOUBLE, 8192);
+  __typeart_alloc((const void*)(base + 65536), TYPEART_INT32, 4);
+
+  // CHECK: Status OK: type_id=6 count=8192
+  type_check(base);
+  // CHECK: Status OK: type_id=6 count=4096
+  type_check(base + 32768);
+  // CHECK: Status OK: type_id=2 count=2
+  type_check(base + 65544);
+
+  __typeart_free((const void*)base);
+  // CHECK: Status not OK: TYPEART_UNKNOWN_ADDRESS
+  type_check(base + 32768);
+  // CHECK: Status OK: type_id=2 count=4
+  type_check(base + 65536);
+
+  __typeart_free((const void*)(base + 65536));
+  return 0;
+}
@@ -0,0 +1,57 @@
+// RUN: %run %s --manual 2>&1 | %filecheck %s
+
+#include "../../lib/runtime/CallbackInterface.h"
+#include "util.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+// With TYPEART_DEFERRED_FREE, heap frees are queued and applied in batches. Queries and allocations must not observe
+// a pending free.
+
+void type_check(const void* addr) {
+  int id_result         = 0;
+  size_t count_check    = 0;
+  typeart_status status = typeart_get_type(addr, &id_result, &count_check);
+
+  if (status != TYPEART_OK) {
+    fprintf(stderr, "Status not OK: %s\n", err_code_to_string(status));
+  } else {
+    fprintf(stderr, "Status OK: type_id=%i count=%zu\n", id_result, count_check);
+  }
+}
+
+int main(void) {
+  const char* base = (const char*)(uintptr_t)0x60000000;
+
+  __typeart_alloc((const void*)base, TYPEART_DOUBLE, 8);
+  __typeart_free((const void*)base);
+  // CHECK: Status not OK: TYPEART_UNKNOWN_ADDRESS
+  type_check(base + 8);
+
+  // Address reuse after a (pending) free is no missing free:
+  // CHECK-NOT: Pointer already in map
+  __typeart_alloc((const void*)base, TYPEART_INT32, 4);
+  __typeart_free((const void*)base);
+  __typeart_alloc((const void*)base, TYPEART_FLOAT, 4);
+  // CHECK: Status OK: type_id=5 count=3
+  type_check(base + 4);
+  __typeart_free((const void*)base);
+
+  // More frees than fit into a single batch:
+  for (int i = 0; i < 200; ++i) {
+    __typeart_alloc((const void*)(base + i * 64), TYPEART_INT64, 8);
+  }
+  for (int i = 0; i < 200; ++i) {
+    __typeart_free((const void*)(base + i * 64));
+  }
+  // Trace output of the applied frees may be interleaved with the queries:
+  // CHECK: Status not OK: TYPEART_UNKNOWN_ADDRESS
+  // CHECK: Status not OK: TYPEART_UNKNOWN_ADDRESS
+  type_check(base + 64);
+  type_check(base + 199 * 64);
+
+  // CHECK: Free on unregistered address
+  __typeart_free((const void*)(base + 1));
+  return 0;
+}
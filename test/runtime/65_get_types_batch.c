@@ -0,0 +1,57 @@
+// RUN: %run %s --manual 2>&1 | %filecheck %s
+
+#include "../../lib/runtime/CallbackInterface.h"
+#include "util.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Batched queries (e.g., all displacements of a derived datatype), addresses passed in arbitrary order.
+
+int main(void) {
+  const char* heap  = (const char*)(uintptr_t)0x70000000;
+  const char* other = heap + 8192;
+  const char* stack = heap + 16384;
+
+  __typeart_alloc((const void*)heap, TYPEART_DOUBLE, 64);
+  __typeart_alloc((const void*)other, TYPEART_INT32, 16);
+  __typeart_alloc_stack((const void*)stack, TYPEART_FLOAT, 4);
+
+  const void* addrs[] = {other + 8, heap + 256, (const void*)(uintptr_t)0x1000, heap, stack + 4, heap + 3, other};
+  const size_t num    = sizeof(addrs) / sizeof(addrs[0]);
+  int type_ids[sizeof(addrs) / sizeof(addrs[0])];
+  size_t counts[sizeof(addrs) / sizeof(addrs[0])];
+  typeart_status statuses[sizeof(addrs) / sizeof(addrs[0])];
+
+  typeart_status status = typeart_get_types(addrs, num, type_ids, counts, statuses);
+  // CHECK: Batch: TYPEART_UNKNOWN_ADDRESS
+  fprintf(stderr, "Batch: %s\n", err_code_to_string(status));
+
+  // CHECK-NEXT: 0: TYPEART_OK type_id=2 count=14
+  // CHECK-NEXT: 1: TYPEART_OK type_id=6 count=32
+  // CHECK-NEXT: 2: TYPEART_UNKNOWN_ADDRESS
+  // CHECK-NEXT: 3: TYPEART_OK type_id=6 count=64
+  // CHECK-NEXT: 4: TYPEART_OK type_id=5 count=3
+  // CHECK-NEXT: 5: TYPEART_BAD_ALIGNMENT
+  // CHECK-NEXT: 6: TYPEART_OK type_id=2 count=16
+  for (size_t i = 0; i < num; ++i) {
+    if (statuses[i] == TYPEART_OK) {
+      fprintf(stderr, "%zu: %s type_id=%i count=%zu\n", i, err_code_to_string(statuses[i]), type_ids[i], counts[i]);
+    } else {
+      fprintf(stderr, "%zu: %s\n", i, err_code_to_string(statuses[i]));
+    }
+  }
+
+  // CHECK-NEXT: Valid batch: TYPEART_OK
+  status = typeart_get_types(&addrs[3], 2, type_ids, counts, statuses);
+  fprintf(stderr, "Valid batch: %s\n", err_code_to_string(status));
+
+  // CHECK-NEXT: Null batch: TYPEART_ERROR
+  status = typeart_get_types(addrs, num, NULL, counts, statuses);
+  fprintf(stderr, "Null batch: %s\n", err_code_to_string(status));
+
+  __typeart_leave_scope(1);
+  __typeart_free((const void*)other);
+  __typeart_free((const void*)heap);
+  return 0;
+}
@@ -0,0 +1,54 @@
+// RUN: %run %s 2>&1 | %filecheck %s
+
+#include "util.h"
+
+#include <stddef.h>
+#include <stdio.h>
+
+typedef struct {
+  int a;
+  double b;
+  float c[2];
+} DataStruct;
+
+void query_check(const void* addr) {
+  typeart_query_result result;
+  typeart_status status = typeart_query_full(addr, &result);
+
+  if (status != TYPEART_OK) {
+    fprintf(stderr, "Status not OK: %s\n", err_code_to_string(status));
+    return;
+  }
+  fprintf(stderr, "Containing: type_id=%i count=%zu offset=%zu base_offset=%td\n", result.containing_type_id,
+          result.containing_count, result.byte_offset, (const char*)addr - (const char*)result.base_address);
+  fprintf(stderr, "Layout: members=%zu extent=%zu\n", result.layout.num_members, result.layout.extent);
+  if (result.type_status != TYPEART_OK) {
+    fprintf(stderr, "Type not OK: %s\n", err_code_to_string(result.type_status));
+  } else {
+    fprintf(stderr, "Type: type_id=%i count=%zu\n", result.type_id, result.count);
+  }
+}
+
+int main(void) {
+  DataStruct data[5];
+  // CHECK: Containing: type_id=257 count=4 offset=16 base_offset=40
+  // CHECK-NEXT: Layout: members=3 extent=24
+  // CHECK-NEXT: Type: type_id=5 count=2
+  query_check(&data[1].c[0]);
+
+  // CHECK: Containing: type_id=257 count=5 offset=1 base_offset=1
+  // CHECK-NEXT: Layout: members=3 extent=24
+  // CHECK-NEXT: Type not OK: TYPEART_BAD_ALIGNMENT
+  query_check((const char*)&data[0].a + 1);
+
+  double values[4];
+  // CHECK: Containing: type_id=6 count=2 offset=0 base_offset=16
+  // CHECK-NEXT: Layout: members=0 extent=0
+  // CHECK-NEXT: Type: type_id=6 count=2
+  query_check(&values[2]);
+
+  // CHECK: Status not OK: TYPEART_UNKNOWN_ADDRESS
+  query_check((const void*)1);
+
+  return 0;
+}
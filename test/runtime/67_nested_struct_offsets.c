@@ -0,0 +1,61 @@
+// RUN: %run %s 2>&1 | %filecheck %s
+
+#include "util.h"
+
+#include <stddef.h>
+#include <stdio.h>
+
+// Interior pointers of nested structs and struct arrays (resolved with the flattened layouts).
+
+typedef struct {
+  int a;
+  double b[2];
+} Inner;
+
+typedef struct {
+  char c;
+  Inner in;
+  float f[3];
+  Inner arr[2];
+} Mid;
+
+void type_check(const void* addr) {
+  int id_result         = 0;
+  size_t count_check    = 0;
+  typeart_status status = typeart_get_type(addr, &id_result, &count_check);
+
+  if (status != TYPEART_OK) {
+    fprintf(stderr, "Status not OK: %s\n", err_code_to_string(status));
+  } else {
+    fprintf(stderr, "Status OK: type_id=%i count=%zu\n", id_result, count_check);
+  }
+}
+
+int main(void) {
+  Mid data[2];
+
+  // CHECK: Status OK: type_id={{[0-9]+}} count=1
+  type_check(&data[0].in);
+  // CHECK-NEXT: Status OK: type_id=6 count=2
+  type_check(&data[0].in.b[0]);
+  // CHECK-NEXT: Status OK: type_id=6 count=1
+  type_check(&data[0].in.b[1]);
+  // CHECK-NEXT: Status OK: type_id=5 count=1
+  type_check(&data[0].f[2]);
+  // CHECK-NEXT: Status OK: type_id=6 count=2
+  type_check(&data[0].arr[0].b[0]);
+  // Outermost type at the address (arr[1], not its member a):
+  // CHECK-NEXT: Status OK: type_id={{[0-9]+}} count=1
+  type_check(&data[1].arr[1].a);
+
+  // Padding after c, and after f:
+  // CHECK-NEXT: Status not OK: TYPEART_BAD_ALIGNMENT
+  type_check(&data[0].c + 1);
+  // CHECK-NEXT: Status not OK: TYPEART_BAD_ALIGNMENT
+  type_check((const char*)&data[0].f[2] + sizeof(float));
+  // Middle of a double:
+  // CHECK-NEXT: Status not OK: TYPEART_BAD_ALIGNMENT
+  type_check((const char*)&data[1].arr[0].b[1] + 4);
+
+  return 0;
+}
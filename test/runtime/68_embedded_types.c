@@ -0,0 +1,28 @@
+// RUN: %run %s --clean_types -typeart-embed-types 2>&1 | %filecheck %s
+
+#include "../../lib/runtime/RuntimeInterface.h"
+
+#include <stdio.h>
+
+struct Datastruct {
+  int start;
+  double middle;
+  float end;
+};
+
+int main(int argc, char** argv) {
+  // CHECK: [Trace] TypeART Runtime Trace
+  // CHECK-NOT: No type file with default name
+
+  // CHECK: [Trace] Alloc [[POINTER:0x[0-9a-fA-F]+]] 256 struct.Datastruct 24 1
+  struct Datastruct data = {0};
+
+  int type_id  = -1;
+  size_t count = 0;
+  typeart_get_type(&data.middle, &type_id, &count);
+  // CHECK: Type: double 1
+  printf("Type: %s %zu\n", typeart_get_type_name(type_id), count);
+
+  // CHECK: [Trace] Free [[POINTER]] 256 struct.Datastruct 24 1
+  return data.start;
+}
@@ -0,0 +1,104 @@
+// RUN: %run %s 2>&1 | %filecheck %s
+
+#include "util.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Primitive type signatures are independent of the struct nesting, only different layouts have different signatures.
+
+typedef struct {
+  int a;
+  double b[2];
+} Inner;
+
+typedef struct {
+  char c;
+  Inner in[2];
+} Nested;
+
+typedef struct {
+  char c;
+  int a0;
+  double b0[2];
+  int a1;
+  double b1[2];
+} Flat;
+
+typedef struct {
+  Inner x;
+} Wrapped;
+
+typedef struct {
+  int a;
+  double b[2];
+} Unwrapped;
+
+void print_signature(const void* addr) {
+  int type_id = 0;
+  typeart_get_type_id(addr, &type_id);
+
+  typeart_type_signature signature;
+  typeart_status status = typeart_get_type_signature(type_id, &signature);
+  if (status != TYPEART_OK) {
+    fprintf(stderr, "Status not OK: %s\n", err_code_to_string(status));
+    return;
+  }
+  fprintf(stderr, "Signature:");
+  for (size_t i = 0; i < signature.num_entries; ++i) {
+    const typeart_signature_entry* entry = &signature.entries[i];
+    if (entry->type_id == TYPEART_SIGNATURE_REPEAT) {
+      fprintf(stderr, " (%d,%zu,%zu,%zu,%zu)", entry->type_id, entry->count, entry->offset, entry->stride,
+              entry->length);
+    } else {
+      fprintf(stderr, " (%d,%zu,%zu)", entry->type_id, entry->count, entry->offset);
+    }
+  }
+  fprintf(stderr, "\n");
+}
+
+uint64_t hash_of(const void* addr) {
+  int type_id = 0;
+  typeart_get_type_id(addr, &type_id);
+  typeart_type_signature signature;
+  typeart_get_type_signature(type_id, &signature);
+  if (typeart_get_signature_hash(signature.entries, signature.num_entries) != signature.hash) {
+    fprintf(stderr, "Error: Hash mismatch\n");
+  }
+  return signature.hash;
+}
+
+int main(void) {
+  Nested nested;
+  Flat flat;
+  Wrapped wrapped;
+  Unwrapped unwrapped;
+  double d;
+
+  // CHECK: Signature: (6,1,0)
+  print_signature(&d);
+  // The array of Inner is a repeat run of the signature of Inner:
+  // CHECK-NEXT: Signature: (0,1,0) (255,7,1) (254,2,8,24,3) (2,1,8) (255,4,12) (6,2,16)
+  print_signature(&nested);
+  // CHECK-NEXT: Signature: (0,1,0) (255,3,1) (2,1,4) (6,2,8) (2,1,24) (255,4,28) (6,2,32)
+  print_signature(&flat);
+
+  // CHECK-NOT: Error
+  // CHECK: Hashes differ: 1
+  fprintf(stderr, "Hashes differ: %i\n", hash_of(&nested) != hash_of(&flat));
+
+  typeart_type_signature signature;
+  // CHECK-NEXT: Status: TYPEART_INVALID_ID
+  fprintf(stderr, "Status: %s\n", err_code_to_string(typeart_get_type_signature(1000, &signature)));
+
+  // Same layout, different nesting:
+  // CHECK-NEXT: Signature: (2,1,0) (255,4,4) (6,2,8)
+  print_signature(&wrapped);
+  // CHECK-NEXT: Signature: (2,1,0) (255,4,4) (6,2,8)
+  print_signature(&unwrapped);
+  // CHECK-NOT: Error
+  // CHECK: Hashes equal: 1
+  fprintf(stderr, "Hashes equal: %i\n", hash_of(&wrapped) == hash_of(&unwrapped));
+
+  return 0;
+}
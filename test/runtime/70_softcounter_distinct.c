@@ -0,0 +1,29 @@
+// RUN: %run %s 2>&1 | %filecheck %s --check-prefix=EXACT
+// RUN: TYPEART_DISTINCT_COUNT=hll:12 %run %s 2>&1 | %filecheck %s --check-prefix=SKETCH
+// REQUIRES: softcounter
+
+#include "../../lib/runtime/RuntimeInterface.h"
+
+#include <stdlib.h>
+
+int main(void) {
+  double* d = (double*)malloc(1000 * sizeof(double));
+  int type_id;
+  size_t count;
+  // Each address is checked twice, but counted once:
+  for (int round = 0; round < 2; ++round) {
+    for (int i = 0; i < 1000; ++i) {
+      typeart_get_type(&d[i], &type_id, &count);
+    }
+  }
+  free(d);
+  return 0;
+}
+
+// EXACT: Addresses checked          : 2000 , - , -
+// EXACT-NEXT: Distinct Addresses checked : 1000 , - , -
+
+// The estimate for 2^12 registers has a bound of +/-3.2% (two standard errors), for small counts it is more accurate
+// SKETCH: Addresses checked          : 2000 , - , -
+// SKETCH-NEXT: Distinct Addresses checked : {{(9[5-9][0-9]|10[0-4][0-9])}} , +/-3.2% , -
+// SKETCH: Distinct Addresses missed  : 0 , +/-3.2% , -
@@ -0,0 +1,34 @@
+// RUN: TYPEART_TRACE_FILE=%t.trace %run %s 2>&1
+// RUN: %trace_decode %t.trace | %filecheck %s
+// RUN: %trace_decode --summary %t.trace | %filecheck %s --check-prefix=SUMMARY
+// RUN: %trace_decode --format=csv %t.trace | %filecheck %s --check-prefix=CSV
+// REQUIRES: event_trace
+
+#include "../../lib/runtime/RuntimeInterface.h"
+
+#include <stdlib.h>
+
+int main(void) {
+  double* d = (double*)malloc(10 * sizeof(double));
+  int type_id;
+  size_t count;
+  typeart_get_type(&d[2], &type_id, &count);
+  typeart_get_type((void*)0x1, &type_id, &count);
+  free(d);
+  return 0;
+}
+
+// Status of (de-)allocations are AllocState/FreeState flags (OK: 2, with NO_INIT: 3), of queries the typeart_status
+// CHECK: {{[0-9]+}} T0 alloc_heap [[ADDR:0x[0-9a-f]+]] 6 double 10 (0x{{[0-9a-f]+}}) 3
+// CHECK: {{[0-9]+}} T0 query 0x{{[0-9a-f]+}} 6 double 8 (0x{{[0-9a-f]+}}) 0
+// CHECK: {{[0-9]+}} T0 query 0x1 255 typeart_unknown_struct 0 (0x{{[0-9a-f]+}}) 1
+// CHECK: {{[0-9]+}} T0 free_heap [[ADDR]] 6 double 10 (0x{{[0-9a-f]+}}) 2
+
+// SUMMARY: alloc_heap: 1
+// SUMMARY: free_heap: 1
+// SUMMARY: query: 2
+// SUMMARY: lost: 0
+// SUMMARY-NEXT: threads: 1
+
+// CSV: timestamp,thread,kind,address,type_id,type_name,count,site,status
+// CSV: {{[0-9]+}},0,alloc_heap,0x{{[0-9a-f]+}},6,double,10,0x{{[0-9a-f]+}},3
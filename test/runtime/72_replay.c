@@ -0,0 +1,30 @@
+// RUN: TYPEART_TRACE_FILE=%t.trace %run %s 2>&1
+// RUN: %replay %t.trace --sample=1 --format=csv | %filecheck %s
+// RUN: %replay --size=2 --iterations=1 --sample=1 | %filecheck %s --check-prefix=SYNTHETIC
+// REQUIRES: event_trace
+
+#include "../../lib/runtime/RuntimeInterface.h"
+
+#include <stdlib.h>
+
+int main(void) {
+  double* d = (double*)malloc(10 * sizeof(double));
+  int type_id;
+  size_t count;
+  typeart_get_type(&d[2], &type_id, &count);
+  typeart_get_type((void*)0x1, &type_id, &count);
+  free(d);
+  return 0;
+}
+
+// Each operation is sampled, one row per backend and operation
+// CHECK: backend,threads,events,seconds,events_per_second,peak_rss_kib,rss_growth_kib,operation,samples,p50_ns
+// CHECK: {{[a-z-]+}},1,{{[0-9]+}},{{[0-9.]+}},{{[0-9]+}},{{[0-9]+}},{{-?[0-9]+}},alloc,{{[1-9][0-9]*}},
+// CHECK-NEXT: {{[a-z-]+}},1,{{[0-9]+}},{{.*}},free,1,
+// CHECK: {{[a-z-]+}},1,{{[0-9]+}},{{.*}},query,2,
+
+// SYNTHETIC: Replay with 1 thread(s)
+// SYNTHETIC: backend events events/s
+// SYNTHETIC-NOT: failed
+// SYNTHETIC: Latency [ns] of 1 in 1 operations
+// SYNTHETIC: {{[a-z-]+}} query {{[0-9]+}}
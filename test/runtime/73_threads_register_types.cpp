@@ -0,0 +1,114 @@
+// clang-format off
+// RUN: %run %s --clean_types --thread --manual 2>&1 | %filecheck %s --check-prefix=CHECK-TSAN
+// RUN: %run %s --clean_types --thread --manual 2>&1 | %filecheck %s
+// REQUIRES: thread
+// clang-format on
+
+#include "../../lib/runtime/CallbackInterface.h"
+#include "util.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+// Embedded type tables are registered by module constructors, e.g., of a dlopen-ed library, while other threads query.
+
+namespace {
+constexpr int num_modules{512};
+
+// Binary type table with a single struct { double member; }, see TypeIO.cpp:
+struct Table {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t num_structs;
+  uint64_t num_members;
+  uint64_t names_size;
+  int32_t type_id;
+  int32_t flags;
+  uint64_t extent;
+  uint64_t member_begin;
+  uint64_t record_members;
+  uint64_t name_begin;
+  uint64_t name_length;
+  uint64_t offset;
+  uint64_t count;
+  int32_t member_type;
+  int32_t padding;
+  char name[16];
+};
+
+Table make_table(int type_id) {
+  Table table{};
+  std::memcpy(table.magic, "TYPEARTB", sizeof(table.magic));
+  table.version        = 1;
+  table.byte_order     = 0x01020304;
+  table.num_structs    = 1;
+  table.num_members    = 1;
+  table.type_id        = type_id;
+  table.flags          = 1;
+  table.extent         = sizeof(double);
+  table.record_members = 1;
+  table.count          = 1;
+  table.member_type    = TYPEART_DOUBLE;
+  table.name_length    = std::snprintf(table.name, sizeof(table.name), "struct.T%d", type_id);
+  table.names_size     = table.name_length;
+  return table;
+}
+
+void register_table(int type_id) {
+  const auto table = make_table(type_id);
+  __typeart_register_types(&table, sizeof(table));
+}
+
+std::atomic<bool> done{false};
+}  // namespace
+
+void query() {
+  typeart_struct_layout first{};
+  if (typeart_resolve_type_id(256, &first) != TYPEART_OK) {
+    fprintf(stderr, "Error: Unknown type 256\n");
+    return;
+  }
+  size_t queries{0};
+  while (!done.load() || queries == 0) {
+    typeart_struct_layout layout{};
+    const auto status = typeart_resolve_type_id(256, &layout);
+    if (status != TYPEART_OK || layout.extent != sizeof(double) || std::strcmp(layout.name, "struct.T256") != 0) {
+      fprintf(stderr, "Error: Type 256 changed\n");
+      return;
+    }
+    ++queries;
+  }
+  // Layouts of earlier queries stay valid:
+  fprintf(stderr, "Resolved: %s %zu %i\n", first.name, first.extent, first.member_types[0]);
+}
+
+int main(int argc, char** argv) {
+  register_table(256);
+  std::thread t(query);
+
+  for (int module = 1; module < num_modules; ++module) {
+    register_table(256 + module);
+  }
+  done.store(true);
+  t.join();
+
+  // CHECK: Resolved: struct.T256 8 6
+  // CHECK-NOT: Error
+  int resolved{0};
+  for (int type_id = 256; type_id < 256 + num_modules; ++type_id) {
+    typeart_struct_layout layout{};
+    if (typeart_resolve_type_id(type_id, &layout) == TYPEART_OK) {
+      ++resolved;
+    }
+  }
+  // CHECK: Registered: 512
+  fprintf(stderr, "Registered: %i\n", resolved);
+
+  // CHECK-TSAN-NOT: ThreadSanitizer
+
+  return 0;
+}
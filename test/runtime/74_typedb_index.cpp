@@ -0,0 +1,141 @@
+// RUN: %run %s --manual 2>&1 | %filecheck %s
+
+#include "../../lib/typelib/TypeDB.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Struct IDs are indexed densely (from TYPEART_NUM_RESERVED_IDS), all other IDs (e.g., hashed IDs) in an
+// open-addressing table with linear probing.
+
+namespace {
+
+constexpr int num_dense = 800;
+
+// Mirrors the slot hash of the sparse index in TypeDB.cpp:
+size_t sparse_hash(int type_id) {
+  return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(type_id)) * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+std::string name_of(int id) {
+  return "struct.s" + std::to_string(id);
+}
+
+size_t extent_of(int id) {
+  return static_cast<size_t>(id % 97) + 1;
+}
+
+void register_struct(typeart::TypeDB& db, int id) {
+  typeart::StructTypeInfo info{id, name_of(id), extent_of(id)};
+  db.registerStruct(info);
+}
+
+int count_errors(const typeart::TypeDB& db, const std::vector<int>& ids) {
+  int errors{0};
+  for (const int id : ids) {
+    const auto* info = db.getStructInfo(id);
+    if (!db.isValid(id) || info == nullptr || info->name != name_of(id) || db.getTypeSize(id) != extent_of(id)) {
+      printf("Error lookup of %i\n", id);
+      ++errors;
+    }
+  }
+  return errors;
+}
+
+int count_found(const typeart::TypeDB& db, const std::vector<int>& ids) {
+  int found{0};
+  for (const int id : ids) {
+    if (db.isValid(id) || db.getStructInfo(id) != nullptr || db.getTypeSize(id) != 0) {
+      printf("Error unregistered %i found\n", id);
+      ++found;
+    }
+  }
+  return found;
+}
+
+// IDs far beyond the dense range, with the same slot in a table of (up to) 256 slots:
+std::vector<int> colliding_ids(size_t count, size_t skip) {
+  std::vector<int> ids;
+  size_t matches{0};
+  for (int id = 2000000000; ids.size() < count; --id) {
+    if ((sparse_hash(id) & 255) == 7 && matches++ >= skip) {
+      ids.push_back(id);
+    }
+  }
+  return ids;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  typeart::TypeDB db;
+
+  // Registered before the dense range covers it, found in the sparse index afterwards:
+  const int late_dense = TYPEART_NUM_RESERVED_IDS + 1100;
+  register_struct(db, late_dense);
+
+  // Linear probing, the colliding IDs share a probe sequence:
+  const auto colliding = colliding_ids(6, 0);
+  for (const int id : colliding) {
+    register_struct(db, id);
+  }
+  // CHECK: Colliding: 0 errors
+  printf("Colliding: %i errors\n", count_errors(db, colliding));
+  // CHECK: Colliding unregistered: 0 found
+  printf("Colliding unregistered: %i found\n", count_found(db, colliding_ids(3, 6)));
+
+  // Dense IDs with gaps (every third ID):
+  std::vector<int> dense;
+  std::vector<int> dense_gaps;
+  for (int id = TYPEART_NUM_RESERVED_IDS; id < TYPEART_NUM_RESERVED_IDS + 3 * num_dense / 2; ++id) {
+    if (id == late_dense) {
+      continue;
+    }
+    if (id % 3 == 0) {
+      dense_gaps.push_back(id);
+      continue;
+    }
+    dense.push_back(id);
+    register_struct(db, id);
+  }
+
+  // Enough hashed IDs for the sparse index to grow several times (rehashing the colliding IDs):
+  std::vector<int> hashed;
+  std::vector<int> hashed_unregistered;
+  for (int index = 0; index < 500; ++index) {
+    const int id = 1000000007 + index * 4099;
+    if (index % 5 == 0) {
+      hashed_unregistered.push_back(id);
+      continue;
+    }
+    hashed.push_back(id);
+    register_struct(db, id);
+  }
+
+  // CHECK-NEXT: Dense: 0 errors
+  printf("Dense: %i errors\n", count_errors(db, dense));
+  // CHECK-NEXT: Late dense: 0 errors
+  printf("Late dense: %i errors\n", count_errors(db, {late_dense}));
+  // CHECK-NEXT: Hashed: 0 errors
+  printf("Hashed: %i errors\n", count_errors(db, hashed));
+  // CHECK-NEXT: Colliding after growth: 0 errors
+  printf("Colliding after growth: %i errors\n", count_errors(db, colliding));
+
+  // CHECK-NEXT: Dense gaps: 0 found
+  printf("Dense gaps: %i found\n", count_found(db, dense_gaps));
+  // CHECK-NEXT: Beyond dense: 0 found
+  printf("Beyond dense: %i found\n", count_found(db, {TYPEART_NUM_RESERVED_IDS + 3 * num_dense}));
+  // CHECK-NEXT: Hashed unregistered: 0 found
+  printf("Hashed unregistered: %i found\n", count_found(db, hashed_unregistered));
+  // CHECK-NEXT: Colliding unregistered after growth: 0 found
+  printf("Colliding unregistered after growth: %i found\n", count_found(db, colliding_ids(3, 6)));
+
+  // CHECK-NEXT: Structs: 1207
+  printf("Structs: %zu\n", db.getNumStructs());
+
+  return 0;
+}
+
+// CHECK-NOT: Error
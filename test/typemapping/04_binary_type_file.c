@@ -0,0 +1,50 @@
+// clang-format off
+// RUN: rm %type_file | %c-to-llvm %s | %apply-typeart -S 2>&1
+// RUN: %types_convert %type_file %t.bin
+// RUN: %types_convert --format=yaml %t.bin %t.yaml
+// RUN: cat %t.yaml | %filecheck %s
+// RUN: head -c 8 %t.bin | %filecheck %s --check-prefix=BINARY
+// clang-format on
+
+// Round trip of the type file through the binary format.
+
+#include <stdlib.h>
+
+typedef struct s2_t {
+  int a;   // 0
+  char b;  // 4
+  long c;  // 8
+} s2;
+
+typedef struct s4_t {
+  int a;           // 0
+  double b[3];     // 8
+  double c[3];     // 32
+  struct s4_t* d;  // 56
+} s4;
+
+int main(int argc, char** argv) {
+  s2* b = malloc(sizeof(s2));
+  s4* d = malloc(sizeof(s4));
+  free(d);
+  free(b);
+  return 0;
+}
+
+// BINARY: TYPEARTB
+
+// CHECK: - id:              256
+// CHECK: name:            struct.s2_t
+// CHECK:         extent:          16
+// CHECK: member_count:    3
+// CHECK: offsets:         [ 0, 4, 8 ]
+// CHECK: types:           [ 2, 0, 3 ]
+// CHECK: sizes:           [ 1, 1, 1 ]
+
+// CHECK: - id:              257
+// CHECK: name:            struct.s4_t
+// CHECK:         extent:          64
+// CHECK: member_count:    4
+// CHECK: offsets:         [ 0, 8, 32, 56 ]
+// CHECK: types:           [ 2, 6, 6, 10 ]
+// CHECK: sizes:           [ 1, 3, 3, 1 ]
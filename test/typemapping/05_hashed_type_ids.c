@@ -0,0 +1,55 @@
+// clang-format off
+// RUN: %c-to-llvm %s | %apply-typeart -typeart-type-ids=hash -typeart-type-store=file -typeart-types=%t-a.yaml -S 2>&1
+// RUN: %c-to-llvm -DSECOND_MODULE %s | %apply-typeart -typeart-type-ids=hash -typeart-type-store=file -typeart-types=%t-b.yaml -S 2>&1
+// RUN: cat %t-a.yaml %t-b.yaml | %filecheck %s --check-prefix=SAME-ID
+// RUN: %types_convert --format=yaml %t-a.yaml %t-b.yaml %t.yaml
+// RUN: cat %t.yaml | %filecheck %s
+// clang-format on
+
+// Hashed type IDs of a struct are the same in separately compiled modules, which are merged afterwards.
+
+#include <stdlib.h>
+
+typedef struct s2_t {
+  int a;   // 0
+  char b;  // 4
+  long c;  // 8
+} s2;
+
+typedef struct s3_t {
+  double a;  // 0
+  int b[2];  // 8
+} s3;
+
+typedef struct s4_t {
+  int a;           // 0
+  double b[3];     // 8
+  double c[3];     // 32
+  struct s4_t* d;  // 56
+} s4;
+
+int main(int argc, char** argv) {
+  s4* d = malloc(sizeof(s4));
+#ifdef SECOND_MODULE
+  s3* c = malloc(sizeof(s3));
+  free(c);
+#else
+  s2* b = malloc(sizeof(s2));
+  free(b);
+#endif
+  free(d);
+  return 0;
+}
+
+// SAME-ID: - id: [[S4_ID:[0-9]+]]
+// SAME-ID-NEXT: name: struct.s4_t
+// SAME-ID: - id: [[S4_ID]]
+// SAME-ID-NEXT: name: struct.s4_t
+
+// CHECK-NOT: id: 256
+// CHECK: name: struct.s4_t
+// CHECK-NOT: name: struct.s4_t
+// CHECK: name: struct.s2_t
+// CHECK-NOT: name: struct.s4_t
+// CHECK: name: struct.s3_t
+// CHECK-NOT: name: struct.s4_t
@@ -0,0 +1,41 @@
+// clang-format off
+// RUN: rm -f %t.journal
+// RUN: %c-to-llvm %s | %apply-typeart -typeart-type-store=journal -typeart-types=%t.journal -S 2>&1
+// RUN: %c-to-llvm -DSECOND_MODULE %s | %apply-typeart -typeart-type-store=journal -typeart-types=%t.journal -S 2>&1
+// RUN: head -c 8 %t.journal | %filecheck %s --check-prefix=JOURNAL
+// RUN: %types_convert --format=yaml %t.journal %t.yaml
+// RUN: cat %t.yaml | %filecheck %s
+// clang-format on
+
+// Each module appends only its new types to the type journal.
+
+#include <stdlib.h>
+
+typedef struct s2_t {
+  int a;   // 0
+  char b;  // 4
+  long c;  // 8
+} s2;
+
+typedef struct s3_t {
+  double a;  // 0
+  int b[2];  // 8
+} s3;
+
+int main(int argc, char** argv) {
+  s2* b = malloc(sizeof(s2));
+#ifdef SECOND_MODULE
+  s3* c = malloc(sizeof(s3));
+  free(c);
+#endif
+  free(b);
+  return 0;
+}
+
+// JOURNAL: TYPEARTJ
+
+// CHECK: - id: 256
+// CHECK-NEXT: name: struct.s2_t
+// CHECK: - id: 257
+// CHECK-NEXT: name: struct.s3_t
+// CHECK-NOT: name: struct.s2_t
@@ -0,0 +1,41 @@
+// clang-format off
+// RUN: rm -f %t.journal
+// RUN: %c-to-llvm %s | %apply-typeart -typeart-type-store=journal -typeart-types=%t.journal -S 2>&1
+// Torn segment (size field of 4096 bytes, followed by 4 bytes only), e.g., of a crashed compilation:
+// RUN: printf '\000\020\000\000\000\000\000\000torn' >> %t.journal
+// RUN: %c-to-llvm -DSECOND_MODULE %s | %apply-typeart -typeart-type-store=journal -typeart-types=%t.journal -S 2>&1 | %filecheck %s --check-prefix=APPEND
+// RUN: %types_convert --format=yaml %t.journal %t.yaml
+// RUN: cat %t.yaml | %filecheck %s
+// clang-format on
+
+// The next module removes the torn segment before appending its types.
+
+#include <stdlib.h>
+
+typedef struct s2_t {
+  int a;   // 0
+  char b;  // 4
+  long c;  // 8
+} s2;
+
+typedef struct s3_t {
+  double a;  // 0
+  int b[2];  // 8
+} s3;
+
+int main(int argc, char** argv) {
+  s2* b = malloc(sizeof(s2));
+#ifdef SECOND_MODULE
+  s3* c = malloc(sizeof(s3));
+  free(c);
+#endif
+  free(b);
+  return 0;
+}
+
+// APPEND: Removing incomplete type journal segment
+
+// CHECK: - id: 256
+// CHECK-NEXT: name: struct.s2_t
+// CHECK: - id: 257
+// CHECK-NEXT: name: struct.s3_t
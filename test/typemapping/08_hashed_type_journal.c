@@ -0,0 +1,38 @@
+// clang-format off
+// RUN: rm -f %t.types
+// RUN: %c-to-llvm %s | %apply-typeart -typeart-type-ids=hash -typeart-types=%t.types -S 2>&1
+// RUN: %c-to-llvm -DSECOND_MODULE %s | %apply-typeart -typeart-type-ids=hash -typeart-types=%t.types -S 2>&1
+// RUN: head -c 8 %t.types | %filecheck %s --check-prefix=JOURNAL
+// RUN: %types_convert --format=yaml %t.types %t.yaml
+// RUN: cat %t.yaml | %filecheck %s
+// clang-format on
+
+// With hashed type IDs, modules (compiled in parallel) append to a shared type journal by default.
+
+#include <stdlib.h>
+
+typedef struct s2_t {
+  int a;   // 0
+  char b;  // 4
+  long c;  // 8
+} s2;
+
+typedef struct s3_t {
+  double a;  // 0
+  int b[2];  // 8
+} s3;
+
+int main(int argc, char** argv) {
+  s2* b = malloc(sizeof(s2));
+#ifdef SECOND_MODULE
+  s3* c = malloc(sizeof(s3));
+  free(c);
+#endif
+  free(b);
+  return 0;
+}
+
+// JOURNAL: TYPEARTJ
+
+// CHECK-DAG: name: struct.s2_t
+// CHECK-DAG: name: struct.s3_t
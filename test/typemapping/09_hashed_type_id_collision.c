@@ -0,0 +1,50 @@
+// clang-format off
+// RUN: %c-to-llvm %s | %apply-typeart -typeart-type-ids=hash -typeart-type-store=file -typeart-types=%t-a.yaml -S 2>&1
+// RUN: %c-to-llvm -DSECOND_MODULE %s | %apply-typeart -typeart-type-ids=hash -typeart-type-store=file -typeart-types=%t-b.yaml -S 2>&1
+// RUN: cat %t-a.yaml %t-b.yaml | %filecheck %s --check-prefix=SAME-ID
+// RUN: (%types_convert --format=yaml %t-a.yaml %t-b.yaml %t.yaml || true) 2>&1 | %filecheck %s --check-prefix=CONVERT
+// RUN: rm -f %t-both.yaml
+// RUN: (%c-to-llvm -DBOTH_MODULES %s | %apply-typeart -typeart-type-ids=hash -typeart-type-store=file -typeart-types=%t-both.yaml -S 2>&1 || true) | %filecheck %s --check-prefix=COLLISION
+// A different seed of all modules resolves the collision:
+// RUN: %c-to-llvm %s | %apply-typeart -typeart-type-ids=hash -typeart-type-id-seed=1 -typeart-type-store=file -typeart-types=%t-a1.yaml -S 2>&1
+// RUN: %c-to-llvm -DSECOND_MODULE %s | %apply-typeart -typeart-type-ids=hash -typeart-type-id-seed=1 -typeart-type-store=file -typeart-types=%t-b1.yaml -S 2>&1
+// RUN: %types_convert --format=yaml %t-a1.yaml %t-b1.yaml %t.yaml
+// RUN: cat %t.yaml | %filecheck %s
+// clang-format on
+
+// The names of the structs are chosen for colliding hashed type IDs (with the default seed). Each struct gets the same
+// ID in all modules, independent of the other types of a module.
+
+#include <stdlib.h>
+
+struct c69297 {
+  int a;
+};
+
+struct c71453 {
+  int a;
+};
+
+int main(int argc, char** argv) {
+#if !defined(SECOND_MODULE) || defined(BOTH_MODULES)
+  struct c69297* a = malloc(sizeof(struct c69297));
+  free(a);
+#endif
+#if defined(SECOND_MODULE) || defined(BOTH_MODULES)
+  struct c71453* b = malloc(sizeof(struct c71453));
+  free(b);
+#endif
+  return 0;
+}
+
+// SAME-ID: - id: 1360670294
+// SAME-ID-NEXT: name: struct.c69297
+// SAME-ID: - id: 1360670294
+// SAME-ID-NEXT: name: struct.c71453
+
+// CONVERT: Type struct.c71453 of {{.*}} conflicts with type struct.c69297 (ID 1360670294)
+
+// COLLISION: Type ID collision of struct.c71453 with struct.c69297 (ID 1360670294)
+
+// CHECK-DAG: name: struct.c69297
+// CHECK-DAG: name: struct.c71453